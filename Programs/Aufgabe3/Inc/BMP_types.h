@@ -19,6 +19,7 @@
 #define BMP_SIGNATURE          0x4d42
 #define BI_RGB                 0
 #define BI_RLE8                1
+#define BI_RLE4                2       // compressed format, 4 bit/pixel
 #define MAX_COLOR_TABLE_SIZE   256
 
 typedef struct tagBITMAPFILEHEADER {
@@ -2,14 +2,54 @@
 #define BMP_READER_H
  
 #include <stdint.h>
+#include <stdbool.h>
 #include "BMP_types.h"
+#include "span.h"
  
 // Liest Header und Palette, setzt interne Status-Variablen
 int bmp_start(BITMAPFILEHEADER *fh, BITMAPINFOHEADER *ih, RGBQUAD *pal);
  
-// Liest GENAU eine Zeile (dekomprimiert RLE oder entfernt Padding automatisch)
-int bmp_read_row(uint8_t *row, int width);
+// true: bmp_start löscht das LCD nicht, zeigt weder Debugzeile noch Fehlermeldung (nur Rückgabewert)
+void bmp_set_quiet(bool quiet);
  
+// Grund, warum bmp_start das Format ablehnt (Text der Fehlermeldung), NULL wenn unterstützt
+const char *bmp_unsupported(const BITMAPINFOHEADER *ih);
+ 
+// Liest GENAU eine Zeile als Spans (RLE-Läufe bleiben Läufe, 1/4 Bit werden ausgepackt, row->literal muss gesetzt sein)
+int bmp_read_row_spans(SpanRow *row, int width);
+ 
+// Liest GENAU eine unkomprimierte 24-Bit-Zeile (3 Byte B,G,R pro Pixel, ohne Padding) nach row
+int bmp_read_row_rgb24(uint8_t *row, int width);
+ 
+// Empfänger für 24-Bit-Pixel im Streaming-Modus (n Pixel B,G,R ab Spalte x, lesbar bis 1 Byte dahinter)
+typedef void (*Rgb24Sink)(int x, const uint8_t *bgr, int n);
+ 
+// Streaming für Bilder breiter als der Zeilenpuffer: GENAU eine Zeile direkt an den Empfänger,
+// ohne die Zeile zu speichern (RLE8/RLE4/1/4 Bit: Läufe/Literale, 24 Bit: Blöcke von max. 128 Pixeln)
+int bmp_stream_row_spans(const SpanSink *sink);
+int bmp_stream_row_rgb24(int width, Rgb24Sink sink);
+ 
+// Überliest GENAU eine Zeile (RLE8/RLE4: nur Opcodes parsen, keine Pixel schreiben)
+int bmp_skip_row(int width);
+ 
+/**
+ * @brief Springt per seekFile (input.h) an den Anfang von Quellzeile row (von unten gezählt)
+ *        und fordert nur die Bytes bis einschließlich Zeile lastRow an. Danach liefern die
+ *        Zeilenfunktionen row, row + 1, ... Unkomprimiert wird die Position berechnet,
+ *        RLE8/RLE4 springt über den Zeilenindex des ersten Durchlaufs (jede n-te Zeile)
+ *        und überliest die Zeilen bis row.
+ * @retval EOK, NOK wenn der Sender nicht springen kann oder row noch nicht im Index ist
+ */
+int bmp_seek_rows(int row, int lastRow);
+
+/**
+ * @brief Fordert die Quellzeilen rows[0..count-1] (von unten gezählt) per sampleRows (input.h)
+ *        in einer Übertragung an. 24 Bit: von jeder Zeile nur width Pixel (je 3 Bytes B,G,R aus
+ *        der Mitte jedes Abschnitts), 1/4 Bit: die ganzen Zeilen für die Zeilenfunktionen.
+ * @retval EOK, NOK bei RLE oder wenn der Sender keine Stichproben kann
+ */
+int bmp_sample_rows(const uint16_t *rows, int count, int width);
+
 // Setzt den RLE-Decoder zurück (wichtig bei neuem Bild)
 void bmp_reset(void);
  
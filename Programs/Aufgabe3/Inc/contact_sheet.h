@@ -0,0 +1,36 @@
+#ifndef CONTACT_SHEET_H
+#define CONTACT_SHEET_H
+
+#include "lcd_output.h"
+
+/*
+ * Kontaktabzug: SHEET_COLS x SHEET_ROWS Vorschaubilder der Dateien des Senders auf einer Seite.
+ * Zuerst werden die Header aller Dateien der Seite in einer Übertragung geholt (openHeaders),
+ * damit steht das Raster samt Seitenverhältnissen, bevor ein Pixel übertragen ist.
+ * Danach pro Datei: Palette lesen, pro Ausgabezeile genau eine Quellzeile dekodieren
+ * (nur die gebrauchten Spalten landen im Box-Filter), die übrigen Zeilen unkomprimiert
+ * überspringen (seekFile) bzw. bei RLE nur parsen, nach der letzten gebrauchten Zeile
+ * die Datei abbrechen (stopFile). Ohne Sprung werden höchstens THUMB_MAX_PARSED_ROWS
+ * Quellzeilen gelesen. Raster und Vorschaubilder (im Bild-Cache, frame_cache.h) bleiben
+ * erhalten, die Seite erscheint nach einem Bild ohne neue Übertragung, solange der Cache reicht.
+ */
+
+#define SHEET_COLS   4
+#define SHEET_ROWS   3
+#define SHEET_CELLS  (SHEET_COLS * SHEET_ROWS)
+#define SHEET_WIDTH  LCD_WIDTH
+#define SHEET_HEIGHT LCD_HEIGHT
+
+/**
+ * @brief Zeichnet die Seite mit den Dateien first, first + 1, ... (höchstens SHEET_CELLS,
+ *        nicht über das Ende der Dateiliste hinaus). Nicht unterstützte Dateien erscheinen
+ *        als rote Zelle.
+ * @param first  Index der ersten Datei in der Liste des Senders
+ * @retval Anzahl der Zellen auf der Seite, NOK wenn der Sender keine Dateien auswählen kann
+ */
+int contact_sheet_show(int first);
+
+// Zelle unter dem LCD-Punkt (x, y), zeilenweise von links oben gezählt
+int contact_sheet_cell(int x, int y);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Cache für fertig skalierte Bilder (RGB565-Zeilen, wie sie ans LCD gehen).
+ * Schlüssel ist der Hash über Header + ersten Burst (getHeadHash aus input.h),
+ * für Vorschaubilder des Kontaktabzugs ein Schlüssel aus Dateiindex und Header.
+ * Die Zeilen liegen zeilenweise lauflängenkodiert in einer festen Arena,
+ * bei Platzmangel wird das am längsten nicht gezeigte Bild verdrängt (LRU).
+ */
+
+#define FRAME_CACHE_ARENA_SIZE  (64u * 1024u) //Bytes für alle Bilder zusammen
+#define FRAME_CACHE_MAX_ENTRIES 8             //Höchstens so viele Bilder
+#define FRAME_CACHE_LINE_WIDTH  480           //Pixel pro LCD-Zeile
+
+// Beginnt die Aufzeichnung eines neuen Bildes (eine laufende Aufzeichnung wird verworfen)
+void frame_cache_begin(void);
+
+// Wie frame_cache_begin, aber nur die Spalten x .. x + w - 1 jeder Zeile (Vorschaubild)
+void frame_cache_begin_rect(int x, int w);
+
+/**
+ * @brief Zeichnet eine ausgegebene LCD-Zeile auf (line zeigt auf die w Pixel ab Spalte x,
+ *        bei frame_cache_begin auf die ganze Zeile). Zeilen müssen lückenlos von unten nach oben
+ *        kommen (lcdY fällt um 1), sonst wird das Bild nicht gecacht. Passt die Zeile nicht
+ *        mehr in die Arena, werden ältere Bilder verdrängt.
+ */
+void frame_cache_add_line(int lcdY, const uint16_t *line);
+
+// Legt die Aufzeichnung unter key ab (Bild vollständig und fehlerfrei angezeigt)
+void frame_cache_commit(uint32_t key);
+
+// Verwirft die laufende Aufzeichnung (Lesefehler, Abbruch)
+void frame_cache_cancel(void);
+
+/**
+ * @brief Zeichnet das Bild zu key aus dem Cache per lcd_draw_row_async neu.
+ *        Eine laufende Aufzeichnung wird verworfen.
+ * @retval true bei Treffer, false wenn key nicht im Cache ist
+ */
+bool frame_cache_show(uint32_t key);
+
+#endif
@@ -1,6 +1,36 @@
 #ifndef _INPUT_H
 #define _INPUT_H
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd_output.h"
+
+#define HEAD_HASH_BYTES 2048   // number of bytes (header + first burst) that identify a file
+#define SEEK_TO_END 0xFFFFFFFFu // length for seekFile: up to the end of the file
+#define HEADERS_SIZE 54        // bytes per file sent by openHeaders (BMP file header + info header)
+#define PANEL_WIDTH  LCD_WIDTH // LCD geometry reported to the Python program (setPanelFit)
+#define PANEL_HEIGHT LCD_HEIGHT
+
+/**
+* @brief Statistics of the receive path (DMA mode)
+*/
+typedef struct {
+   uint32_t bytesReceived;  // bytes received since initInput
+   uint32_t maxFill;        // max. number of unread bytes in the RX ring buffer
+   uint32_t overruns;       // number of detected RX ring buffer overruns
+   uint32_t burstSize;      // negotiated burst size in bytes
+   uint32_t window;         // negotiated number of outstanding bursts, 0: old protocol
+   uint32_t baudRate;       // current (negotiated) baud rate, 0: unknown
+   bool     crcMode;        // bursts are protected by a CRC32
+   uint32_t crcErrors;      // bursts with a wrong CRC
+   uint32_t retransmits;    // bursts requested again (wrong CRC, sequence number, length or timeout)
+   uint32_t prefetched;     // bytes of the current file that came from the prefetch buffer
+   bool     seekMode;       // Python can send the current file again from an offset (seekFile)
+   bool     abortMode;      // Python stops a file at once (stopFile), otherwise the granted bursts run out
+   bool     sampleMode;     // Python sends sampled rows and columns of the current file (sampleRows)
+   bool     panelMode;      // Python fits the images into PANEL_WIDTH x PANEL_HEIGHT before sending them
+} InputStats;
+
 /**
 * @brief This function setups communication protocol to Python send file program
 * @param None
@@ -8,6 +38,15 @@
 */
 extern void initInput(void);
 
+/**
+* @brief This function decides whether initInput reports the panel geometry. The Python program
+*        then sends every image already fitted into PANEL_WIDTH x PANEL_HEIGHT. Call it before
+*        initInput, default true. Pan/zoom needs the full resolution and switches it off.
+* @param fit  false: the Python program sends the original files
+* @retval None
+*/
+extern void setPanelFit(bool fit);
+
 /**
 * @brief This function asks the Python program to open a new file. 
 *        If all files has been read, it blocks until a new file has been
@@ -17,6 +56,93 @@ extern void initInput(void);
 */
 extern void openNextFile(void);
 
+/**
+* @brief This function reads the rest of the current file and asks the Python program for the
+*        next one. Its first bytes are collected by prefetchPoll, the next openNextFile reads
+*        them from RAM before it continues with the UART (slideshow while an image is shown).
+* @param None
+* @retval None
+*/
+extern void prefetchNextFile(void);
+
+/**
+* @brief This function moves the bursts of the next file that have arrived into the prefetch
+*        buffer and requests further ones while there is room. It never waits for data.
+* @param None
+* @retval true while more bursts of the next file fit into the prefetch buffer
+*/
+extern bool prefetchPoll(void);
+
+/**
+* @brief This function reads the rest of the current file (or range) and asks the Python program
+*        to send the bytes [offset, offset + length) of the current file again. Afterwards
+*        nextSpan etc. read them like a file that ends after length bytes.
+* @param offset  Position in the current file
+* @param length  Number of bytes, SEEK_TO_END: up to the end of the file
+* @retval EOK, NOK if the Python program cannot seek (no window or old program) or while prefetching
+*/
+extern int seekFile(uint32_t offset, uint32_t length);
+
+/**
+* @brief This function reads the rest of the current file (or range) and asks the Python program
+*        for sampled pixels of some rows of the current file, all in one range: for every listed
+*        row r the pixels x = (2 j + 1) * srcWidth / (2 * width), j = 0 .. width - 1, of
+*        pixelSize bytes at offset + r * stride + x * pixelSize. Afterwards nextSpan etc. read
+*        count * width * pixelSize bytes. getFilePos and getHeadHash are not valid for them.
+* @param offset     Position of row 0 in the current file
+* @param stride     Bytes per row in the file
+* @param pixelSize  Bytes per pixel, 0: the whole rows (count * stride bytes, pixels smaller than a byte)
+* @param srcWidth   Pixels per row in the file
+* @param width      Sampled pixels per row
+* @param rows       Row numbers (< 65536) in the order they are sent
+* @param count      Number of rows, 1 .. 255
+* @retval EOK, NOK if the Python program cannot sample (no window or old program) or while prefetching
+*/
+extern int sampleRows(uint32_t offset, uint32_t stride, int pixelSize, int srcWidth, int width,
+                      const uint16_t *rows, int count);
+
+/**
+* @brief This function returns the position of the next unread byte in the current file.
+* @param None
+* @retval Offset from the start of the file (not from the start of a range)
+*/
+extern uint32_t getFilePos(void);
+
+/**
+* @brief This function stops the current file (or range) without reading the rest. A Python
+*        program that understands the abort command stops at once, only the bursts already on
+*        their way are thrown away. Otherwise no further bursts are requested and the line must
+*        become idle. Afterwards nextSpan returns 0 until the next file or range is opened.
+* @param None
+* @retval None
+*/
+extern void stopFile(void);
+
+/**
+* @brief This function returns the number of files the Python program has announced.
+* @param None
+* @retval Number of files, 0 if the Python program cannot select files (no window or old program)
+*/
+extern int getFileCount(void);
+
+/**
+* @brief This function stops the current file and selects the file the next openNextFile opens.
+*        The following files are opened in the order of the list behind it.
+* @param index  Index in the file list of the Python program (wraps around)
+* @retval EOK, NOK if the Python program cannot select files
+*/
+extern int selectFile(int index);
+
+/**
+* @brief This function stops the current file and asks the Python program for the first
+*        HEADERS_SIZE bytes of count files from first on (shorter files padded with 0).
+*        They are read with nextSpan etc. like a single file of count * HEADERS_SIZE bytes.
+* @param first  Index of the first file (wraps around)
+* @param count  Number of files, at most 255
+* @retval EOK, NOK if the Python program cannot select files
+*/
+extern int openHeaders(int first, int count);
+
 /**
 * @brief  This function reads the next byte from the current file that will be 
 *         transmitted by Python.
@@ -25,6 +151,22 @@ extern void openNextFile(void);
 */
 extern int nextChar(void);
 
+/**
+* @brief  This function returns the bytes of the current file that are already
+*         received and stored contiguously (no copy). It blocks until at least
+*         one byte is available. The bytes stay valid until consumeSpan is called.
+* @param  data  Set to the first unread byte
+* @retval Number of contiguous bytes at data (never beyond the current burst), 0 on EOF
+*/
+extern int nextSpan(const char **data);
+
+/**
+* @brief  This function marks n bytes returned by nextSpan as read.
+* @param  n  Number of consumed bytes (at most the value returned by nextSpan)
+* @retval None
+*/
+extern void consumeSpan(int n);
+
 /**
 * @brief  This function reads count elements of data, each size bytes long, 
 *         from from the current file that will be transmitted by Python.
@@ -35,5 +177,35 @@ extern int nextChar(void);
 */
 extern int COMread(char*, unsigned int size, unsigned int count);
 
+/**
+* @brief  This function skips n bytes of the current file.
+* @param  n  Number of bytes to skip
+* @retval EOK or EOF if the file ends before n bytes have been skipped.
+*/
+extern int COMskip(unsigned int n);
+
+/**
+* @brief  This function sends one line of text (e.g. a timing report) to the Python program.
+*         Only call it between files, the Python program prints the line.
+* @param  text  Text without line feed
+* @retval None
+*/
+extern void sendText(const char *text);
+
+/**
+* @brief  This function returns the statistics of the receive path.
+* @param  stats  Filled with the current counters
+* @retval None
+*/
+extern void getInputStats(InputStats *stats);
+
+/**
+* @brief  This function returns the FNV-1a hash over the first HEAD_HASH_BYTES bytes
+*         of the current file (BMP header, palette and start of the pixel data).
+* @param  hash  Set to the hash if it is complete
+* @retval true if HEAD_HASH_BYTES bytes (or the whole shorter file) have been consumed
+*/
+extern bool getHeadHash(uint32_t *hash);
+
 #endif
 // EOF
\ No newline at end of file
@@ -4,8 +4,45 @@
 #include <stdint.h>
 #include "BMP_types.h"
 
+/**
+ * Wenn =1, werden Bildzeilen per SPI1-TX-DMA ausgegeben (lcd_draw_row_async),
+ * die CPU kann währenddessen die nächste Zeile dekodieren und skalieren.
+ * Bei =0 arbeitet lcd_draw_row_async synchron über GUI_WriteLine (z.B. Host-Build).
+ */
+// Displaygröße (Querformat), einzige Quelle für alle Module
+#define LCD_WIDTH  480
+#define LCD_HEIGHT 320
+
+#ifndef LCD_ASYNC_OUTPUT
+#define LCD_ASYNC_OUTPUT 1
+#endif
+
+typedef void (*LcdRowDoneCallback)(void);
+
 uint16_t rgb_to_16(RGBQUAD c);
 void lcd_draw_pixel(int x, int y, uint8_t idx, RGBQUAD *pal);
 void lcd_draw_row(int x, int y, uint16_t *buf, int w);
 
+// Initialisiert den DMA-Stream für die asynchrone Zeilenausgabe (nach GUI_init aufrufen)
+void lcd_output_init(void);
+
+/**
+ * @brief Startet die Ausgabe einer Zeile und kehrt sofort zurück.
+ *        Eine noch laufende Ausgabe wird vorher abgewartet.
+ *        buf darf erst nach Abschluss (lcd_wait_idle / Callback) wieder beschrieben werden.
+ *        Gleiche x/w wie beim vorigen Aufruf → der Spaltenbereich wird nicht erneut gesendet.
+ *        Liegt y direkt über der vorigen Zeile, läuft das Adressfenster weiter (ein Fenster pro Bild,
+ *        von unten nach oben gefüllt), es wird nur Write Memory Continue gesendet.
+ */
+void lcd_draw_row_async(int x, int y, const uint16_t *buf, int w);
+
+// Wie lcd_draw_row_async, aber dieselbe Zeile in rows Zeilen ab y (ein Adressfenster, DMA wird im Interrupt neu gestartet)
+void lcd_draw_rows_async(int x, int y, int rows, const uint16_t *buf, int w);
+
+// Wartet, bis die laufende DMA-Ausgabe fertig ist. Vor jedem GUI_*-Aufruf nötig.
+void lcd_wait_idle(void);
+
+// Callback nach jeder fertig ausgegebenen Zeile (Interrupt-Kontext), NULL = keiner
+void lcd_set_row_done_callback(LcdRowDoneCallback cb);
+
 #endif
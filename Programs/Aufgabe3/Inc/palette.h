@@ -1,8 +1,30 @@
 #ifndef PALETTE_H
 #define PALETTE_H
 
+#include <stdint.h>
 #include "BMP_types.h"
 
+/*
+ * Gepackte Palette für den Box-Filter: je Kanal 6 Bit (0..63) in einem 10-Bit-Feld.
+ * Bis zu PAL_PACK_BATCH Einträge können mit einer 32-Bit-Addition pro Pixel
+ * aufsummiert werden, ohne dass ein Feld überläuft (16 * 63 = 1008 < 1024).
+ */
+#define PAL_PACK_SHIFT_R 20
+#define PAL_PACK_SHIFT_G 10
+#define PAL_PACK_MASK    0x3FFu
+#define PAL_PACK_BATCH   16
+
+#define PAL_PACK_R(p) (((p) >> PAL_PACK_SHIFT_R) & PAL_PACK_MASK)
+#define PAL_PACK_G(p) (((p) >> PAL_PACK_SHIFT_G) & PAL_PACK_MASK)
+#define PAL_PACK_B(p) ((p) & PAL_PACK_MASK)
+
+extern uint32_t palPacked[MAX_COLOR_TABLE_SIZE]; // Box-Summen-Darstellung pro Palette-Eintrag
+extern uint16_t pal565[MAX_COLOR_TABLE_SIZE];    // RGB565 pro Palette-Eintrag (1:1-Ausgabe)
+extern uint32_t pal888[MAX_COLOR_TABLE_SIZE];    // 0x00RRGGBB pro Palette-Eintrag (Interpolation beim Hochskalieren)
+
 int load_palette(RGBQUAD *pal, int count);
 
+// Baut palPacked/pal565 einmal pro Bild, nicht benutzte Einträge werden schwarz
+void palette_build_luts(const RGBQUAD *pal, int count);
+
 #endif
@@ -0,0 +1,31 @@
+#ifndef PAN_ZOOM_H
+#define PAN_ZOOM_H
+
+#include <stdbool.h>
+#include "lcd_output.h"
+
+/*
+ * Ausschnitt-Ansicht (Pan/Zoom) eines schon einmal vollständig gelesenen Bildes.
+ * Gezeigt wird ein LCD-großer Ausschnitt bei 1:1 oder 2:1 (ein Quellpixel → 2x2 LCD-Pixel).
+ * Die Zeilen kommen per bmp_seek_rows aus der Datei (RLE über den Zeilenindex des ersten
+ * Durchlaufs), angefordert werden nur die Zeilen des Ausschnitts, nur seine Spalten
+ * werden nach RGB565 gewandelt.
+ */
+
+#define PAN_ZOOM_LCD_WIDTH  LCD_WIDTH
+#define PAN_ZOOM_LCD_HEIGHT LCD_HEIGHT
+#define PAN_ZOOM_MAX        2   //Größte Vergrößerung
+
+// Bildgröße für die folgenden Ausschnitte (nach bmp_start und dem ersten Durchlauf bis zur letzten Zeile)
+void pan_zoom_begin(int srcW, int srcH, bool isRgb24);
+
+/**
+ * @brief Zeichnet den Ausschnitt, dessen linke obere Ecke im Quellbild bei (*x, *y) liegt
+ *        (y von oben gezählt). Die Ecke wird so begrenzt, dass der Ausschnitt im Bild bleibt,
+ *        ein Bild kleiner als der Ausschnitt wird zentriert.
+ * @param zoom  1 oder PAN_ZOOM_MAX
+ * @retval EOK, NOK wenn nicht gesprungen werden kann oder die Datei zu früh endet
+ */
+int pan_zoom_draw(int *x, int *y, int zoom);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef PIPE_STATS_H
+#define PIPE_STATS_H
+
+#include <stdint.h>
+
+/**
+ * Wenn =1, werden pro Bild die DWT-Zyklen jeder Stufe der Pipeline gezählt
+ * (Header, Warten auf UART, Dekodieren, Skalieren, LCD) und nach dem Bild als
+ * eine Zeile auf dem LCD und an das Python-Programm (sendText) ausgegeben.
+ * Bei =0 werden alle PIPE_*-Makros zu nichts, der Code kostet nichts.
+ */
+#ifndef PIPE_STATS
+#define PIPE_STATS 0
+#endif
+
+typedef enum {
+    PIPE_OTHER,   // alles, was keiner Stufe zugeordnet ist
+    PIPE_HEADER,  // Header + Palette (bmp_start)
+    PIPE_UART,    // Warten auf Daten vom UART (input.c), auch innerhalb von Dekodieren/Header
+    PIPE_DECODE,  // bmp_read_row_* / bmp_skip_row / bmp_stream_row_*
+    PIPE_SCALE,   // scale_*
+    PIPE_LCD,     // Zeilenausgabe inkl. Warten auf den DMA und Bild-Cache
+    PIPE_STAGES
+} PipeStage;
+
+#if PIPE_STATS
+// Zähler auf 0, DWT-Zykluszähler einschalten (vor openNextFile aufrufen)
+void pipe_stats_begin(void);
+
+// Ab jetzt zählt stage, liefert die bisherige Stufe
+PipeStage pipe_stats_switch(PipeStage stage);
+
+// Zusammenfassung (ms pro Stufe, KB/s, Zeilen/s) auf LCD und UART, vorher lcd_wait_idle()
+void pipe_stats_report(int rows);
+
+#define PIPE_SWITCH(stage)       pipe_stats_switch(stage)
+#define PIPE_ENTER(saved, stage) PipeStage saved = pipe_stats_switch(stage)
+#define PIPE_LEAVE(saved)        pipe_stats_switch(saved)
+#else
+#define PIPE_SWITCH(stage)
+#define PIPE_ENTER(saved, stage)
+#define PIPE_LEAVE(saved)
+#endif
+
+#endif
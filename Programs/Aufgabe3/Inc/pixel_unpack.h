@@ -0,0 +1,24 @@
+#ifndef PIXEL_UNPACK_H
+#define PIXEL_UNPACK_H
+
+#include <stdint.h>
+
+/*
+ * Gepackte Palette-Pixel (4 und 1 Bit, höchstwertige Bits = linkes Pixel) in
+ * ein Byte pro Pixel auspacken, wie es SpanRow/SpanSink erwarten.
+ * Gearbeitet wird wortweise (4 Quellbytes bzw. 1 Quellbyte → 8 Indizes),
+ * es werden GENAU pixels Bytes geschrieben.
+ */
+
+#define UNPACK_CHUNK 256 //Pixel pro Zwischenpuffer in Decoder und Reader (Vielfaches von 8)
+
+// 4 Bit: pixels Indizes aus (pixels + 1) / 2 Bytes
+void unpack_4bpp(uint8_t *dst, const uint8_t *src, int pixels);
+
+// 1 Bit: pixels Indizes (0/1) aus (pixels + 7) / 8 Bytes
+void unpack_1bpp(uint8_t *dst, const uint8_t *src, int pixels);
+
+// RLE4-Lauf mit zwei Farben: pixels Indizes abwechselnd first, second
+void unpack_pair(uint8_t *dst, uint8_t first, uint8_t second, int pixels);
+
+#endif
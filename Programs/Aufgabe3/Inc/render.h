@@ -0,0 +1,57 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pipe_stats.h"
+
+/*
+ * Ein Bild von der Eingabe aufs LCD: Header lesen, Zeilen dekodieren, skalieren und
+ * von unten nach oben zeichnen (Ringpuffer, Box-Filter, Hochskalieren, Spalten-Akkumulatoren
+ * für breite Bilder), dazu Bild-Cache und Abbruch der Übertragung.
+ * Unkomprimierte Bilder, die verkleinert werden, kommen mit coarsePass in zwei Durchläufen,
+ * wenn der Sender springen kann (bmp_seek_rows): zuerst jede PREVIEW_STEP-te Ausgabezeile
+ * über das ganze Bild, jede über ihren Block vervielfacht, danach alle Zeilen in einem Bereich
+ * von unten nach oben. RLE-Bilder und das alte Protokoll zeigen die Vorschau nur mitlaufend.
+ * Gemeinsam für main.c und den Host-Benchmark (host/bench.c).
+ */
+
+#define MAX_BMP_WIDTH 2400     //Maximale BMP-Breite für den Ringpuffer, breitere Bilder laufen im Streaming-Modus
+#define MAX_STREAM_WIDTH 65535 //Streaming-Modus: Spalten sind uint16_t (ColumnSpan/RowSpan)
+#define RING_BUFFER_SIZE 6     //Anzahl der Zeilen im Ring-Puffer (Teil C)
+#define PROGRESSIVE_PREVIEW 1  //Verkleinern: jede PREVIEW_STEP-te Zeile über ihren ganzen Block zeigen, bevor die übrigen kommen
+#define PREVIEW_STEP 8
+
+// Meldet den Wechsel der Pipeline-Stufe (pipe_stats_switch oder eigene Zeitmessung), liefert die bisherige
+typedef PipeStage (*RenderStageHook)(PipeStage stage);
+
+typedef struct {
+    bool upscale;          // kleine Bilder auf Displaygröße hochskalieren (sonst Originalgröße, zentriert)
+    bool useCache;         // Bild-Cache: Treffer zeichnen, fertige Bilder ablegen
+    bool readToEnd;        // restliche Zeilen nach dem Bild überlesen (Zeilenindex für bmp_seek_rows)
+    bool coarsePass;       // unkomprimiert + Sprünge: erst Grobdurchlauf über das ganze Bild (PROGRESSIVE_PREVIEW)
+    RenderStageHook stage; // NULL = keine Zeitmessung
+} RenderConfig;
+
+typedef struct {
+    int srcW, srcH;
+    int bitCount;
+    bool isRgb24;
+    bool streamed;         // breites Bild: Dekodieren und Skalieren verschränkt (beides unter PIPE_DECODE/PIPE_SCALE)
+    int offsetX, offsetY;  // Lage des angezeigten Bildes auf dem LCD
+    int displayW, displayH;
+    int outRows;           // ausgegebene LCD-Zeilen
+    bool cacheHit;         // Bild kam aus dem Bild-Cache
+    uint32_t cacheKey;
+    bool cacheKeyKnown;
+} RenderResult;
+
+/**
+ * @brief Zeichnet die mit openNextFile geöffnete Datei (GUI_clear vorher durch den Aufrufer).
+ *        Danach ist die Übertragung beendet (stopFile) und die letzte Zeile ausgegeben (lcd_wait_idle).
+ *        Abgelehnte Header und zu breite Bilder melden sich über lcdErrorMsg.
+ * @retval EOK wenn das Bild vollständig und fehlerfrei gelesen wurde, sonst NOK
+ */
+int render_image(const RenderConfig *cfg, RenderResult *res);
+
+#endif
@@ -2,9 +2,49 @@
 #define RLE_DECODER_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "span.h"
 
-int rle_decode_row(uint8_t *row, int width);
-void rle_reset(void);
-void rle_reset_with_height(int h);
+//Escape-Codes nach 0x00 im RLE8/RLE4-Datenstrom (ab 3: Absolute Mode mit b2 Pixeln)
+#define RLE_ESC_EOL   0
+#define RLE_ESC_EOB   1
+#define RLE_ESC_DELTA 2
+
+//Decoder-Zustand an einem Zeilenanfang (Zeilenindex, bmp_seek_rows)
+typedef struct {
+    int32_t resumeX;
+    uint8_t pendingRows;
+    bool    eof;
+} RleMark;
+
+// Setzt den Decoder für ein neues Bild zurück (nach dem Sprung an bfOffBits), nibbles: RLE4 statt RLE8
+void rle_reset(int width, int height, bool nibbles);
+
+// Merkt sich den Zustand vor der nächsten Zeile (zwischen zwei Zeilen aufrufen)
+void rle_mark(RleMark *mark);
+
+// Setzt den Decoder auf einen mit rle_mark gemerkten Zeilenanfang zurück, row = Anzahl Zeilen davor
+void rle_restore(const RleMark *mark, int row);
+
+/**
+ * @brief Dekodiert die nächste Zeile als Spans (row->literal muss gesetzt sein).
+ *        Delta-Lücken (dx/dy), vorzeitiges Zeilenende und Zeilen nach End Of Bitmap
+ *        werden Hintergrund-Spans (SPAN_BACKGROUND).
+ * @retval 0 OK, -1 Datenstrom vorzeitig zu Ende
+ */
+int rle_decode_row(SpanRow *row);
+
+/**
+ * @brief Überliest die nächste Zeile: Opcodes werden geparst, aber keine Pixel geschrieben.
+ * @retval 0 OK, -1 Datenstrom vorzeitig zu Ende
+ */
+int rle_skip_row(void);
+
+/**
+ * @brief Dekodiert die nächste Zeile direkt an sink, ohne Pixelspeicher.
+ *        Literale werden aus dem Eingabepuffer weitergereicht, Spans sind auf die Bildbreite begrenzt.
+ * @retval 0 OK, -1 Datenstrom vorzeitig zu Ende
+ */
+int rle_stream_row(const SpanSink *sink);
 
 #endif
@@ -1,23 +1,128 @@
 #ifndef SCALER_H
 #define SCALER_H
- 
+
 #include <stdint.h>
 #include "BMP_types.h"
- 
+#include "span.h"
+
+#define SCALER_LINE_WIDTH 480 //Breite einer LCD-Zeile in Pixeln
+
+//Betriebsart nach scaler_init()
+typedef enum {
+    SCALER_DOWN,        // scale <= 1: Box-Filter
+    SCALER_UP_INTEGER,  // ganzzahliger Faktor >= 2: Pixelwiederholung
+    SCALER_UP_BILINEAR  // gebrochener Faktor > 1: bilineare Interpolation (Festkomma)
+} ScalerMode;
+
+/**
+ * Wenn =1, wird zusätzlich der alte Float-Kernel gebaut.
+ * render.c misst dann beide Kernel und zeigt Zeilen/s nebeneinander an.
+ */
+#define SCALER_COMPARE_FLOAT 0
+
+/**
+ * @brief Berechnet einmal pro Bild die Spaltentabelle für den Box-Filter.
+ *        Pro Ausgabespalte: erste Quellspalte, Boxbreite und Gewicht 1/(Breite*Zeilen) in Q32 (gerundet).
+ *
+ * @param srcW              Breite des Originalbildes
+ * @param scale             Skalierungsfaktor (> 1.0 → Hochskalieren, siehe scaler_mode)
+ * @param offsetX           X-Verschiebung für Zentrierung (schwarzer Rand links)
+ * @param displayImageWidth Effektive Breite des Bildes auf dem Screen
+ * @param boxRows           Anzahl Quellzeilen pro Box (boxSize aus render.c)
+ */
+void scaler_init(int srcW, float scale, int offsetX, int displayImageWidth, int boxRows);
+
 /**
  * @brief Skaliert eine Zeile mit Box-Filter und Fit-to-Screen Logik (Letterboxing).
+ *        Nutzt die Tabelle aus scaler_init() und die Paletten-LUTs aus palette_build_luts(),
+ *        rechnet nur mit Integern (keine FPU).
  *
  * @param outBuf            Ausgabepuffer für die LCD-Zeile (480 Pixel, RGB565)
  * @param inputRows         Array der Quellzeilen (Palette-Indizes)
  * @param rowCount          Anzahl der gültigen Quellzeilen
- * @param srcW              Breite des Originalbildes
- * @param scale             Skalierungsfaktor (<= 1.0)
- * @param offsetX           X-Verschiebung für Zentrierung (schwarzer Rand links)
- * @param displayImageWidth Effektive Breite des Bildes auf dem Screen
- * @param pal               Farbpalette
  */
-void scale_line_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount,
-                        int srcW, float scale, int offsetX, int displayImageWidth,
-                        RGBQUAD *pal);
- 
-#endif
\ No newline at end of file
+void scale_line_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount);
+
+/**
+ * @brief Wie scale_line_box_fit, aber auf Span-Zeilen aus bmp_read_row_spans().
+ *        Pro Lauf wird Länge * Farbe auf jede überlappte Ausgabespalte addiert,
+ *        lange einfarbige Läufe kosten damit O(Läufe) statt O(Pixel).
+ *
+ * @param outBuf            Ausgabepuffer für die LCD-Zeile (480 Pixel, RGB565)
+ * @param inputRows         Array der Quellzeilen als Spans
+ * @param rowCount          Anzahl der gültigen Quellzeilen
+ */
+void scale_spans_box_fit(uint16_t *outBuf, SpanRow **inputRows, int rowCount);
+
+/**
+ * @brief Box-Filter für unkomprimierte 24-Bit-Zeilen (B,G,R pro Pixel).
+ *        R und B werden mit SIMD (UXTAB16) gemeinsam in einem Wort summiert,
+ *        bei 1:1 werden je 4 Pixel aus 3 Wörtern nach RGB565 gewandelt.
+ *        Liest pro Zeile bis zu 1 Byte hinter dem letzten Pixel.
+ *
+ * @param outBuf            Ausgabepuffer für die LCD-Zeile (480 Pixel, RGB565)
+ * @param inputRows         Array der Quellzeilen (3 Byte pro Pixel)
+ * @param rowCount          Anzahl der gültigen Quellzeilen
+ */
+void scale_rgb24_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount);
+
+ScalerMode scaler_mode(void);
+
+/**
+ * @brief Exakter Verkleinerungsfaktor (2, 3, 4, 8), für den scaler_init einen
+ *        spezialisierten Kernel gewählt hat, sonst 0 (generischer Kernel).
+ *        Quellzeilen einer Ausgabezeile i sind dann genau i*F .. i*F+F-1.
+ */
+int scaler_int_factor(void);
+
+/**
+ * @brief Hochskalieren: Quellzeilen für Ausgabezeile destY.
+ *        Bilinear wird zwischen y0 und y1 mit fy/256 gemischt, ganzzahlig ist y0 == y1.
+ */
+void scaler_up_rows(int destY, int srcH, int *y0, int *y1, uint32_t *fy);
+
+// SCALER_UP_INTEGER: Quellzeile direkt in die LCD-Zeile vervielfachen (Läufe bleiben Läufe)
+void scale_up_replicate_spans(uint16_t *outBuf, const SpanRow *row);
+void scale_up_replicate_rgb24(uint16_t *outBuf, const uint8_t *row);
+
+/**
+ * @brief SCALER_UP_BILINEAR: Quellzeile srcRow einmal horizontal interpolieren.
+ *        Es werden nur die letzten zwei vorbereiteten Zeilen gehalten (srcRow & 1),
+ *        jede Quellzeile wird also genau einmal dekodiert und interpoliert.
+ *        Die Span-Variante schreibt row->literal aus.
+ */
+void scale_up_prepare_spans(SpanRow *row, int srcRow);
+void scale_up_prepare_rgb24(const uint8_t *row, int srcRow);
+
+// SCALER_UP_BILINEAR: zwei vorbereitete Zeilen vertikal mischen → RGB565
+void scale_up_blend(uint16_t *outBuf, int y0, int y1, uint32_t fy);
+
+/**
+ * Streaming-Modus (Verkleinern, Bild breiter als der Zeilenpuffer in render.c):
+ * Quellzeilen werden nicht gespeichert, sondern beim Dekodieren direkt in die
+ * Spalten-Akkumulatoren (3 x 480 Worte) gefaltet.
+ *  scale_stream_begin()           → Akkumulatoren für die nächste LCD-Zeile leeren
+ *  scale_stream_run/literal/rgb24 → Empfänger für bmp_stream_row_spans / bmp_stream_row_rgb24
+ *  scale_stream_finish_*()        → Box schließen, rowCount = Anzahl gefalteter Quellzeilen
+ */
+void scale_stream_begin(void);
+void scale_stream_run(int x, int len, uint8_t color);
+void scale_stream_literal(int x, const uint8_t *src, int n);
+void scale_stream_rgb24(int x, const uint8_t *src, int n);
+void scale_stream_finish_spans(uint16_t *outBuf, int rowCount);
+void scale_stream_finish_rgb24(uint16_t *outBuf, int rowCount);
+
+/**
+ * Wenn =1, misst render.c pro Bild die Zeit für Lesen + Skalieren
+ * und zeigt Zeilen/s und KB/s an (Vergleich 8-Bit-RLE8 gegen 24-Bit-Pfad).
+ */
+#define SCALER_BENCH 0
+
+#if SCALER_COMPARE_FLOAT
+// Alter Float-Kernel (floorf/ceilf pro Pixel), nur als Vergleichsmessung
+void scale_line_box_fit_float(uint16_t *outBuf, uint8_t **inputRows, int rowCount,
+                              int srcW, float scale, int offsetX, int displayImageWidth,
+                              RGBQUAD *pal);
+#endif
+
+#endif
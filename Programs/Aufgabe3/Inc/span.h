@@ -0,0 +1,53 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <stdint.h>
+
+/*
+ * Lauflängen-Darstellung einer Quellzeile.
+ * Der RLE8-Decoder legt jede Zeile als lückenlose Folge von Spans [x, x+len) ab,
+ * der Box-Filter addiert pro Span len * Farbe statt jeden Pixel einzeln zu lesen.
+ * Kurze Läufe und Absolute-Mode-Pixel landen im Literal-Speicher der Zeile.
+ */
+
+#define SPAN_LITERAL      0xFFFF //color-Wert für "Pixel stehen in literal[x .. x+len)"
+#define SPAN_MIN_RUN      8      //Kürzere Läufe werden als Literal abgelegt
+#define SPAN_MAX_PER_ROW  256    //Span-Kapazität pro Zeile (danach nur noch Literal)
+#define SPAN_BACKGROUND   0      //Palette-Index für Lücken (Delta, vorzeitiges Zeilenende)
+
+typedef struct {
+    uint16_t x;      // erste Quellspalte
+    uint16_t len;    // Anzahl Pixel
+    uint16_t color;  // Palette-Index oder SPAN_LITERAL
+} RowSpan;
+
+typedef struct {
+    RowSpan  spans[SPAN_MAX_PER_ROW];
+    int      count;
+    int      width;    // Zeilenbreite, Spans decken [0, width) vollständig ab
+    uint8_t *literal;  // Pixelspeicher (mind. width Bytes), indiziert mit x
+} SpanRow;
+
+/*
+ * Empfänger für Spans, die nicht in einer SpanRow gespeichert werden
+ * (Streaming-Modus für sehr breite Bilder). Spans einer Zeile kommen
+ * lückenlos und aufsteigend in x, src zeigt direkt in den Eingabepuffer.
+ */
+typedef struct {
+    void (*run)(int x, int len, uint8_t color);
+    void (*literal)(int x, const uint8_t *src, int n);
+} SpanSink;
+
+// Leert die Zeile, literal muss vorher gesetzt sein
+void span_row_reset(SpanRow *row, int width);
+
+// Hängt einen Lauf (len * color) an, schneidet an der Zeilenbreite ab
+void span_put_run(SpanRow *row, int x, int len, uint8_t color);
+
+// Hängt n Pixel am Stück an (Absolute Mode direkt aus dem Eingabepuffer)
+void span_put_literal(SpanRow *row, int x, const uint8_t *src, int n);
+
+// Schreibt alle Läufe in literal[] aus → literal ist danach eine normale Pixelzeile
+void span_row_expand(SpanRow *row);
+
+#endif
@@ -1,6 +1,9 @@
 #include "bmp_reader.h"
 #include "headers.h"
 #include "input.h"
+#include "palette.h"
+#include "rle_decoder.h"
+#include "pixel_unpack.h"
 #include "errorhandler.h"
 #include "LCD_GUI.h"
 #include "fontsFLASH.h"
@@ -17,15 +20,83 @@
 static int g_width = 0;
 static int g_compression = 0;
 static int g_bitCount = 0;
-static bool g_rle_eof = false;
+static uint32_t g_dataOffset = 0; //bfOffBits
+static int g_row = 0;             //Nummer der nächsten Zeile (von unten gezählt)
+static bool g_quiet = false;      //bmp_start ohne LCD-Ausgabe (Kontaktabzug)
+
+/*
+ * Zeilenindex für bmp_seek_rows: Dateiposition und Decoder-Zustand am Anfang jeder
+ * g_indexStep-ten RLE-Zeile, gesammelt beim ersten Durchlauf (jede Zeile wird gelesen
+ * oder überlesen). Der Schritt wächst mit der Bildhöhe, damit ROW_INDEX_SIZE reicht.
+ */
+#define ROW_INDEX_SIZE     256
+#define ROW_INDEX_MIN_STEP 8
+
+typedef struct {
+    uint32_t pos;
+    RleMark  rle;
+} RowIndexEntry;
+
+static RowIndexEntry g_index[ROW_INDEX_SIZE];
+static int g_indexCount = 0;
+static int g_indexStep = ROW_INDEX_MIN_STEP;
+
+static bool is_rle(void)
+{
+    return g_compression == BI_RLE8 || g_compression == BI_RLE4;
+}
+
+//Vor jeder Zeile: beim ersten Durchlauf den Indexeintrag anhängen, nach einem Sprung ist er schon da
+static void index_row(void)
+{
+    if (is_rle() && g_row % g_indexStep == 0 &&
+        g_row / g_indexStep == g_indexCount && g_indexCount < ROW_INDEX_SIZE)
+    {
+        g_index[g_indexCount].pos = getFilePos();
+        rle_mark(&g_index[g_indexCount].rle);
+        g_indexCount++;
+    }
+    g_row++;
+}
 
 //Reset aller globalen Zustände vor Einlesen eines neuen Bildes
 void bmp_reset(void)
 {
+    rle_reset(0, 0, false);
     g_width = 0;
     g_compression = 0;
     g_bitCount = 0;
-    g_rle_eof = false;
+    g_dataOffset = 0;
+    g_row = 0;
+    g_indexCount = 0;
+    g_indexStep = ROW_INDEX_MIN_STEP;
+}
+
+void bmp_set_quiet(bool quiet)
+{
+    g_quiet = quiet;
+}
+
+//Fehlermeldung von bmp_start, im leisen Modus bleibt das LCD unverändert
+static int start_error(const char *msg)
+{
+    if (!g_quiet)
+        lcdErrorMsg(msg);
+    return NOK;
+}
+
+const char *bmp_unsupported(const BITMAPINFOHEADER *ih)
+{
+    // FEHLER 1: Nur 1/4/8 Bit mit Palette oder unkomprimierte 24 Bit BMP unterstützt
+    bool isRgb24 = (ih->biBitCount == 24) && (ih->biCompression == BI_RGB);
+    if (ih->biBitCount != 1 && ih->biBitCount != 4 && ih->biBitCount != 8 && !isRgb24)
+        return "Fehler: Nur 1/4/8/24-Bit BMP!";
+
+    // FEHLER 2: 8 Bit nur als RLE8 (BI_RLE8) erlaubt
+    if (ih->biBitCount == 8 && ih->biCompression != BI_RLE8)
+        return "Fehler: Nicht RLE8 komprimiert!";
+
+    return NULL;
 }
 
 /* bmp_start()
@@ -37,10 +108,8 @@ int bmp_start(BITMAPFILEHEADER *fh, BITMAPINFOHEADER *ih, RGBQUAD *pal)
     char debugBuf[64];
 
     //1) BMP-Header einlesen (nutzt intern COMread → liest 512-Byte-Chunks)
-    if (readHeaders() != EOK) {
-        lcdErrorMsg("Header Read Error");
-        return NOK;
-    }
+    if (readHeaders() != EOK)
+        return start_error("Header Read Error");
 
     getFileHeader(fh);
     getInfoHeader(ih);
@@ -49,59 +118,41 @@ int bmp_start(BITMAPFILEHEADER *fh, BITMAPINFOHEADER *ih, RGBQUAD *pal)
     g_compression = ih->biCompression;
     g_bitCount    = ih->biBitCount;
 
-    
-    // FEHLER 1: Nur 8 Bit BMP unterstützt
-   
-    if (g_bitCount != 8)
-    {
-        lcdErrorMsg("Fehler: Nur 8-Bit BMP!");
-        return NOK;
-    }
+    const char *unsupported = bmp_unsupported(ih);
+    if (unsupported != NULL)
+        return start_error(unsupported);
+    bool isRgb24 = (g_bitCount == 24);
 
     
-    // FEHLER 2: Nur RLE8 (BI_RLE8) erlaubt
+    //Debug-Ausgabe für Entwicklung --> Wird für jedes Bild einmal oben links angezeigt
     
-    if (g_compression != BI_RLE8)
+    if (!g_quiet)
     {
-        lcdErrorMsg("Fehler: Nicht RLE8 komprimiert!");
-        return NOK;
+        GUI_clear(BLACK);
+        snprintf(debugBuf, sizeof(debugBuf),
+                 "W:%d H:%d C:%d B:%d",
+                 (int)ih->biWidth, (int)ih->biHeight,
+                 (int)ih->biCompression, (int)ih->biBitCount);
+
+        Coordinate pos = {0, 0};
+        GUI_disStr(pos, debugBuf, &Font16, WHITE, RED);
     }
 
     
-    //Debug-Ausgabe für Entwicklung --> Wird für jedes Bild einmal oben links angezeigt
+    //Farbpalette lesen (2^biBitCount Einträge zu je 4 Bytes: B,G,R,Res)
     
-    GUI_clear(BLACK);
-    snprintf(debugBuf, sizeof(debugBuf),
-             "W:%d H:%d C:%d B:%d",
-             (int)ih->biWidth, (int)ih->biHeight,
-             (int)ih->biCompression, (int)ih->biBitCount);
-
-    Coordinate pos = {0, 0};
-    GUI_disStr(pos, debugBuf, &Font16, WHITE, RED);
-
-    
-    //Farbpalette lesen (256 Einträge zu je 4 Bytes: B,G,R,Res)
-    
-    int colors = ih->biClrUsed;
-    if (colors == 0) colors = 256;
-
-    for (int i = 0; i < colors; i++)
+    //24 Bit hat keine Palette (biClrUsed ist laut basicChecks 0)
+    int colors = 0;
+    if (!isRgb24)
     {
-        int b   = nextChar();
-        int g   = nextChar();
-        int r   = nextChar();
-        int res = nextChar();
-
-        if (b == EOF || g == EOF || r == EOF)
-        {
-            lcdErrorMsg("EOF in Palette");
-            return NOK;
-        }
+        colors = ih->biClrUsed;
+        if (colors == 0) colors = 1 << g_bitCount;
 
-        pal[i].rgbBlue     = (uint8_t)b;
-        pal[i].rgbGreen    = (uint8_t)g;
-        pal[i].rgbRed      = (uint8_t)r;
-        pal[i].rgbReserved = (uint8_t)res;
+        if (load_palette(pal, colors) != EOK)
+            return start_error("EOF in Palette");
+
+        //Palette einmal vorverarbeiten → Scaler liest nur noch palPacked/pal565
+        palette_build_luts(pal, colors);
     }
 
     
@@ -112,127 +163,220 @@ int bmp_start(BITMAPFILEHEADER *fh, BITMAPINFOHEADER *ih, RGBQUAD *pal)
     int gap              = targetOffset - currentBytesRead;
 
     if (gap < 0)
-    {
-        lcdErrorMsg("Fehler: Negatives Gap");
-        return NOK;
-    }
+        return start_error("Fehler: Negatives Gap");
         //Bytes überspringen
-    for (int i = 0; i < gap; i++)
+    if (COMskip((unsigned int)gap) != EOK)
+        return start_error("EOF in Gap");
+
+    g_dataOffset = fh->bfOffBits;
+    if (is_rle())
     {
-        if (nextChar() == EOF)
-        {
-            lcdErrorMsg("EOF in Gap");
-            return NOK;
-        }
+        rle_reset(g_width, ih->biHeight, g_compression == BI_RLE4);
+        int step = (ih->biHeight + ROW_INDEX_SIZE - 1) / ROW_INDEX_SIZE;
+        g_indexStep = (step > ROW_INDEX_MIN_STEP) ? step : ROW_INDEX_MIN_STEP;
     }
 
     return EOK;
 }
 
-//read_row_rle()  Dekodiert EINE Ausgabezeile aus dem RLE8-Datenstrom
-static int read_row_rle(uint8_t *row, int width)
+// RAW READER (8 Bit unkomprimiert, von bmp_start derzeit abgelehnt)
+
+static int read_row_raw(uint8_t *row, int width)
 {
-    if (g_rle_eof)
-        return 0; // Bitmap ist komplett fertig
+    for (int i = 0; i < width; i++)
+    {
+        int c = nextChar();
+        if (c == EOF)
+            return -1;
+
+        row[i] = (uint8_t)c;
+    }
 
-    int x = 0;
+    int padding = (4 - (width % 4)) % 4;
 
-    while (1)
+    for (int i = 0; i < padding; i++)
     {
-        int b1 = nextChar();
-        int b2 = nextChar();
+        if (nextChar() == EOF)
+            return -1;
+    }
+
+    return 0;
+}
+
+
+// PACKED READER (1/4 Bit unkomprimiert)
+// Zeile blockweise lesen und wortweise auspacken, Indizes gehen als Literal in row oder an sink
+
+static uint8_t packedBuf[UNPACK_CHUNK / 2];  //gepackte Bytes eines Blocks (4 Bit: UNPACK_CHUNK / 2)
+static uint8_t unpackedBuf[UNPACK_CHUNK];    //ausgepackte Indizes
 
-        if (b1 == EOF || b2 == EOF)
+static int read_row_packed(SpanRow *row, const SpanSink *sink, int width)
+{
+    for (int x = 0; x < width; x += UNPACK_CHUNK)
+    {
+        int n = width - x;
+        if (n > UNPACK_CHUNK) n = UNPACK_CHUNK;
+
+        unsigned int bytes = ((unsigned int)n * (unsigned int)g_bitCount + 7u) / 8u;
+        if (COMread((char *)packedBuf, 1, bytes) == EOF)
             return -1;
 
-        // ENCODED MODE (b1 > 0)  / b1 = Anzahl wiederholungen , b2 = Farbindex
-        if (b1 > 0)
-        {
-            int count = b1;
-            int colorIndex = b2;
-
-            for (int i = 0; i < count; i++)
-            {
-                if (x < width)
-                    row[x] = (uint8_t)colorIndex;
-                x++;
-            }
-        }
+        if (g_bitCount == 4)
+            unpack_4bpp(unpackedBuf, packedBuf, n);
+        else
+            unpack_1bpp(unpackedBuf, packedBuf, n);
+
+        if (row != NULL)
+            span_put_literal(row, x, unpackedBuf, n);
         else
-        {
-            // ESCAPE MODE (b1 == 0)
-            if (b2 == 0)
-                return 0; // 0,0 → End Of Line
-
-            if (b2 == 1) //0,1 → End Of Bitmap
-            {
-                g_rle_eof = true;
-                return 0;
-            }
-
-            if (b2 == 2) //0,2,dx,dy → Cursor verschieben
-            {
-                int dx = nextChar();
-                int dy = nextChar();
-
-                x += dx;
-                // dy wird ignoriert (Bild wird Bottom-Up gelesen)
-            }
-            else
-            {
-                // ABSOLUTE MODE
-                int count = b2;
-
-                for (int i = 0; i < count; i++)
-                {
-                    int val = nextChar();
-                    if (val == EOF) return -1;
-
-                    if (x < width)
-                        row[x] = (uint8_t)val;
-                    x++;
-                }
-
-                // Padding (auf Wortgrenze)
-                if (count % 2 != 0)
-                    nextChar();
-            }
-        }
+            sink->literal(x, unpackedBuf, n);
     }
+
+    unsigned int rowBytes = ((unsigned int)width * (unsigned int)g_bitCount + 7u) / 8u;
+    if (COMskip((4u - (rowBytes % 4u)) % 4u) != EOK)
+        return -1;
+
+    return 0;
 }
 
 
-// RAW READER (falls nicht RLE) — wird nicht benutzt, aber bleibt drin
+//24-Bit-Zeile (B,G,R je Pixel) am Stück übernehmen, Padding auf 4 Byte überspringen
 
-static int read_row_raw(uint8_t *row, int width)
+int bmp_read_row_rgb24(uint8_t *row, int width)
 {
-    for (int i = 0; i < width; i++)
-    {
-        int c = nextChar();
-        if (c == EOF)
-            return -1;
+    index_row();
+    unsigned int rowBytes = (unsigned int)width * 3u;
 
-        row[i] = (uint8_t)c;
+    if (COMread((char *)row, 1, rowBytes) == EOF)
+        return -1;
+
+    if (COMskip((4u - (rowBytes % 4u)) % 4u) != EOK)
+        return -1;
+
+    return 0;
+}
+
+
+//Liest eine Zeile als Spans → RLE8/RLE4 ohne Ausschreiben, RAW über den Literal-Speicher
+
+int bmp_read_row_spans(SpanRow *row, int width)
+{
+    span_row_reset(row, width);
+    index_row();
+
+    if (is_rle())
+        return rle_decode_row(row);
+
+    if (g_bitCount < 8)
+        return read_row_packed(row, NULL, width);
+
+    int res = read_row_raw(row->literal, width);
+    if (res == 0)
+    {
+        row->spans[0].x     = 0;
+        row->spans[0].len   = (uint16_t)width;
+        row->spans[0].color = SPAN_LITERAL;
+        row->count = 1;
     }
+    return res;
+}
 
-    int padding = (4 - (width % 4)) % 4;
 
-    for (int i = 0; i < padding; i++)
+//Streaming (Bild breiter als der Zeilenpuffer): Spans gehen direkt an sink, nichts wird gespeichert
+
+int bmp_stream_row_spans(const SpanSink *sink)
+{
+    index_row();
+    if (is_rle())
+        return rle_stream_row(sink);
+
+    if (g_bitCount < 8)
+        return read_row_packed(NULL, sink, g_width);
+
+    return -1; // RAW 8 Bit lehnt bmp_start ab
+}
+
+
+//24 Bit im Streaming-Modus: Zeile in kleinen Blöcken durch rgbChunk an sink reichen
+//(+1 Byte, weil der SIMD-Kernel hinter dem letzten Pixel liest)
+#define RGB24_STREAM_CHUNK 128
+static uint8_t rgbChunk[RGB24_STREAM_CHUNK * 3 + 1];
+
+int bmp_stream_row_rgb24(int width, Rgb24Sink sink)
+{
+    index_row();
+    for (int x = 0; x < width; x += RGB24_STREAM_CHUNK)
     {
-        if (nextChar() == EOF)
+        int n = width - x;
+        if (n > RGB24_STREAM_CHUNK) n = RGB24_STREAM_CHUNK;
+
+        if (COMread((char *)rgbChunk, 1, (unsigned int)n * 3u) == EOF)
             return -1;
+        sink(x, rgbChunk, n);
     }
 
+    unsigned int rowBytes = (unsigned int)width * 3u;
+    if (COMskip((4u - (rowBytes % 4u)) % 4u) != EOK)
+        return -1;
+
     return 0;
 }
 
 
-//Hauptfunktion zum Lesen einer Zeile  → entscheidet zwischen RAW und RLE8
+//Überliest eine Zeile ohne Pixel zu schreiben → RLE8 parst nur die Opcodes
+
+int bmp_skip_row(int width)
+{
+    index_row();
+    if (is_rle())
+        return rle_skip_row();
+
+    unsigned int rowBytes = ((unsigned int)width * (unsigned int)g_bitCount + 7u) / 8u;
+    unsigned int padded   = (rowBytes + 3u) & ~3u;
+    return (COMskip(padded) == EOK) ? 0 : -1;
+}
+
+
+//Sprung zu Quellzeile row, angefordert werden nur die Bytes bis zum Ende von lastRow
 
-int bmp_read_row(uint8_t *row, int width)
+int bmp_seek_rows(int row, int lastRow)
 {
-    if (g_compression == BI_RLE8)
-        return read_row_rle(row, width);
+    if (!is_rle())
+    {
+        uint32_t stride = (((uint32_t)g_width * (uint32_t)g_bitCount + 31u) / 32u) * 4u;
+        if (seekFile(g_dataOffset + (uint32_t)row * stride, (uint32_t)(lastRow - row + 1) * stride) != EOK)
+            return NOK;
+        g_row = row;
+        return EOK;
+    }
+
+    int entry = row / g_indexStep;
+    if (entry >= g_indexCount)
+        return NOK;
+
+    //Bereich endet am ersten Indexeintrag hinter lastRow (letzte Einträge: bis Dateiende)
+    int endEntry = (lastRow + g_indexStep) / g_indexStep;
+    uint32_t length = (endEntry < g_indexCount) ? g_index[endEntry].pos - g_index[entry].pos : SEEK_TO_END;
+    if (seekFile(g_index[entry].pos, length) != EOK)
+        return NOK;
+
+    g_row = entry * g_indexStep;
+    rle_restore(&g_index[entry].rle, g_row);
+    while (g_row < row)
+    {
+        if (bmp_skip_row(g_width) != 0)
+            return NOK;
+    }
+    return EOK;
+}
+
+//Stichprobe per sampleRows: 24 Bit nur width Pixel je Zeile, 1/4 Bit die ganzen Zeilen
 
-    return read_row_raw(row, width);
+int bmp_sample_rows(const uint16_t *rows, int count, int width)
+{
+    if (is_rle())
+        return NOK;
+    uint32_t stride = (((uint32_t)g_width * (uint32_t)g_bitCount + 31u) / 32u) * 4u;
+    int pixelSize = (g_bitCount == 24) ? 3 : 0;
+    return sampleRows(g_dataOffset, stride, pixelSize, g_width, width, rows, count);
 }
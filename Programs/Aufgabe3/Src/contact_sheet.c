@@ -0,0 +1,295 @@
+#include "contact_sheet.h"
+#include "bmp_reader.h"
+#include "headers.h"
+#include "input.h"
+#include "scaler.h"
+#include "lcd_output.h"
+#include "frame_cache.h"
+#include "errorhandler.h"
+#include "LCD_GUI.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#define CELL_WIDTH   (SHEET_WIDTH / SHEET_COLS)
+#define CELL_HEIGHT  (SHEET_HEIGHT / SHEET_ROWS)
+#define CELL_MARGIN  3                //Abstand des Vorschaubildes zum Zellrand
+#define THUMB_MAX_WIDTH 65535         //Spalten sind uint16_t (ColumnSpan), wie MAX_STREAM_WIDTH in render.h
+#define THUMB_SEEK_GAP  4             //ohne Stichprobe: kürzere Lücken zwischen gebrauchten Zeilen mitlesen statt springen
+#define THUMB_STREAM_BUDGET 8192      //ohne Sprung (RLE): höchstens so viele Bytes Bilddaten lesen, darüber bleibt der Platzhalter
+#define THUMB_MAX_ROW   0xFFFF        //Zeilennummern einer Stichprobe sind uint16_t (sampleRows)
+#define COLOR_PLACEHOLDER 0x2104      //dunkelgrau: Platz des Vorschaubildes, bevor Pixel da sind
+#define COLOR_UNSUPPORTED 0x8000      //dunkelrot: Datei kann nicht angezeigt werden
+
+typedef struct {
+    int srcW, srcH;
+    int x, y, w, h;  //Rechteck des Vorschaubildes auf dem LCD
+    float scale;
+    bool ok;
+    bool raw;        //unkomprimiert → Zeilenposition berechenbar (bmp_seek_rows ohne Index)
+    uint32_t key;    //Schlüssel im Bild-Cache (thumb_key)
+} Thumb;
+
+static Thumb thumbs[SHEET_CELLS];
+static int sheetFirst = -1;  //Seite, deren Raster in thumbs steht
+static int sheetCount = 0;
+static RGBQUAD palette[MAX_COLOR_TABLE_SIZE];
+
+//Doppelpuffer wie in render.c: eine Zeile wird gesendet, in die andere schreibt der Scaler
+static uint16_t sheetLines[2][SCALER_LINE_WIDTH];
+static uint8_t sampleBgr[CELL_WIDTH * 3];  //eine Zeile einer 24-Bit-Stichprobe (B,G,R)
+static uint16_t sampleRowList[CELL_HEIGHT];
+
+static const SpanSink thumbSink = { scale_stream_run, scale_stream_literal };
+
+//Rechteck einfarbig füllen (eine Zeile, rows-mal gesendet)
+static void fill_rect(int x, int y, int w, int h, uint16_t color)
+{
+    lcd_wait_idle();
+    for (int i = 0; i < w; i++)
+        sheetLines[0][i] = color;
+    lcd_draw_rows_async(x, y, h, sheetLines[0], w);
+    lcd_wait_idle();
+}
+
+//Quellzeile (von unten gezählt) für Ausgabezeile i: eine Zeile aus der Mitte jeder Box
+static int sample_row(const Thumb *t, int i)
+{
+    int row = (int)(((float)i + 0.5f) / t->scale);
+    return (row < t->srcH) ? row : t->srcH - 1;
+}
+
+//Rest des Bereichs lesen (nur noch der leere Burst) → keine Bursts mehr unterwegs
+static void drain_range(void)
+{
+    const char *data;
+    int n;
+    while ((n = nextSpan(&data)) > 0)
+        consumeSpan(n);
+}
+
+//Schlüssel im Bild-Cache aus Dateiindex und Header, die Dateiliste des Senders ändert sich nicht.
+//FNV-1a über die Worte statt Bytes, ein anderer Raum als getHeadHash (Header + erster Burst)
+static uint32_t thumb_key(int index, const BITMAPFILEHEADER *fh, const BITMAPINFOHEADER *ih)
+{
+    uint32_t words[4] = { (uint32_t)index, fh->bfSize, (uint32_t)ih->biWidth, (uint32_t)ih->biHeight };
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 4; i++)
+        h = (h ^ words[i]) * 16777619u;
+    return h;
+}
+
+//Pass 1: Header aller Dateien der Seite in einer Übertragung, daraus das Raster
+static int layout(int first, int count)
+{
+    for (int k = 0; k < count; k++)
+        thumbs[k].ok = false;
+    if (openHeaders(first, count) != EOK)
+        return NOK;
+
+    for (int k = 0; k < count; k++)
+    {
+        Thumb *t = &thumbs[k];
+        BITMAPFILEHEADER fh;
+        BITMAPINFOHEADER ih;
+        //readHeaders liest immer HEADERS_SIZE Bytes, auch wenn die Prüfung scheitert
+        if (readHeaders() != EOK)
+            continue;
+        getFileHeader(&fh);
+        getInfoHeader(&ih);
+        if (bmp_unsupported(&ih) != NULL || ih.biWidth > THUMB_MAX_WIDTH)
+            continue;
+
+        t->srcW = ih.biWidth;
+        t->srcH = ih.biHeight;
+        t->raw = (ih.biCompression == BI_RGB);
+        t->key = thumb_key(first + k, &fh, &ih);
+
+        float boxW = (float)(CELL_WIDTH - 2 * CELL_MARGIN);
+        float boxH = (float)(CELL_HEIGHT - 2 * CELL_MARGIN);
+        float scaleX = boxW / (float)t->srcW;
+        float scaleY = boxH / (float)t->srcH;
+        t->scale = (scaleX < scaleY) ? scaleX : scaleY;
+        if (t->scale > 1.0f) t->scale = 1.0f;
+
+        t->w = (int)(t->srcW * t->scale);
+        t->h = (int)(t->srcH * t->scale);
+        if (t->w < 1) t->w = 1;
+        if (t->h < 1) t->h = 1;
+        t->x = (k % SHEET_COLS) * CELL_WIDTH + (CELL_WIDTH - t->w) / 2;
+        t->y = (k / SHEET_COLS) * CELL_HEIGHT + (CELL_HEIGHT - t->h) / 2;
+        t->ok = true;
+    }
+    drain_range();
+    return EOK;
+}
+
+//Eine Zeile einer 24-Bit-Stichprobe: w Pixel, schon in Zielbreite → nur umrechnen
+static int read_sampled_rgb24(uint16_t *out, int w)
+{
+    if (COMread((char *)sampleBgr, 3, (unsigned int)w) == EOF)
+        return -1;
+    for (int j = 0; j < w; j++)
+    {
+        RGBQUAD c = { sampleBgr[3 * j], sampleBgr[3 * j + 1], sampleBgr[3 * j + 2], 0 };
+        out[j] = rgb_to_16(c);
+    }
+    return 0;
+}
+
+//Pass 2: ein Vorschaubild, pro Ausgabezeile genau eine Quellzeile. Unkomprimiert kommen alle
+//gebrauchten Zeilen mit einer Anforderung (bmp_sample_rows), 24 Bit sogar nur die gebrauchten
+//Spalten. Die Zeilen landen im Bild-Cache, die nächste Seite mit dieser Datei zeichnet sie
+//ohne Übertragung.
+static int draw_thumb(const Thumb *t)
+{
+    BITMAPFILEHEADER fh;
+    BITMAPINFOHEADER ih;
+    openNextFile();
+    if (bmp_start(&fh, &ih, palette) != EOK || ih.biWidth != t->srcW || ih.biHeight != t->srcH) {
+        stopFile();
+        return NOK;
+    }
+    bool isRgb24 = (ih.biBitCount == 24);
+    scaler_init(t->srcW, t->scale, t->x, t->w, 1);
+
+    InputStats st;
+    getInputStats(&st);
+    //Unkomprimiert: nur die gebrauchten Zeilen anfordern, der Rest der Datei bleibt beim Sender.
+    //Ohne Stichproben Läufe von Zeilen per Sprung, jeder Lauf kostet eine Anfrage.
+    bool sampled = t->raw && st.sampleMode && t->srcH - 1 <= THUMB_MAX_ROW;
+    bool seekRows = t->raw && st.seekMode && !sampled;
+    bool direct = sampled && isRgb24;  //Stichprobe schon in Zielbreite, kein Scaler
+    if (sampled)
+    {
+        for (int i = 0; i < t->h; i++)
+            sampleRowList[i] = (uint16_t)sample_row(t, i);
+        stopFile();
+        if (bmp_sample_rows(sampleRowList, t->h, t->w) != EOK) {
+            stopFile();
+            return NOK;
+        }
+    }
+    else if (seekRows)
+        stopFile();
+    frame_cache_begin_rect(t->x, t->w);
+
+    uint32_t dataStart = getFilePos();
+    int rowsRead = 0;
+    int runEnd = -1;  //letzte Ausgabezeile des angeforderten Bereichs
+    int idx = 0;
+    for (int i = 0; i < t->h; i++)
+    {
+        int row = sample_row(t, i);
+        if (!sampled && !seekRows && getFilePos() - dataStart > THUMB_STREAM_BUDGET)
+            break;  //RLE: obere Zeilen bleiben Platzhalter, die Übertragung endet hier
+        if (sampled)
+            rowsRead = row;  //die Stichprobe enthält nur die gebrauchten Zeilen
+        else if (seekRows && i > runEnd)
+        {
+            //Lauf: folgende Zeilen mit kleinen Lücken gehören in denselben Bereich
+            runEnd = i;
+            while (runEnd + 1 < t->h && sample_row(t, runEnd + 1) - sample_row(t, runEnd) <= THUMB_SEEK_GAP)
+                runEnd++;
+            if (bmp_seek_rows(row, sample_row(t, runEnd)) != EOK) {
+                stopFile();
+                frame_cache_cancel();
+                return NOK;
+            }
+            rowsRead = row;
+        }
+        for (; rowsRead < row; rowsRead++)
+        {
+            if (bmp_skip_row(t->srcW) != 0) {
+                stopFile();
+                frame_cache_cancel();
+                return NOK;
+            }
+        }
+
+        uint16_t *line = sheetLines[idx];
+        int res;
+        if (direct)
+            res = read_sampled_rgb24(line + t->x, t->w);
+        else
+        {
+            scale_stream_begin();
+            res = isRgb24 ? bmp_stream_row_rgb24(t->srcW, scale_stream_rgb24)
+                          : bmp_stream_row_spans(&thumbSink);
+        }
+        rowsRead++;
+        if (res != 0) {
+            stopFile();
+            frame_cache_cancel();
+            return NOK;
+        }
+        if (!isRgb24)
+            scale_stream_finish_spans(line, 1);
+        else if (!direct)
+            scale_stream_finish_rgb24(line, 1);
+
+        //BMP ist Bottom-Up
+        lcd_draw_row_async(t->x, t->y + t->h - 1 - i, line + t->x, t->w);
+        frame_cache_add_line(t->y + t->h - 1 - i, line + t->x);
+        idx ^= 1;
+    }
+
+    //Zeilen über der letzten gebrauchten werden nicht mehr übertragen
+    if (sampled || seekRows || rowsRead == t->srcH)
+        drain_range();
+    else
+        stopFile();
+    frame_cache_commit(t->key);
+    lcd_wait_idle();
+    return EOK;
+}
+
+int contact_sheet_show(int first)
+{
+    int files = getFileCount();
+    if (files <= 0)
+        return NOK;
+    first %= files;
+    int count = files - first;
+    if (count > SHEET_CELLS) count = SHEET_CELLS;
+
+    //Zurück zur selben Seite: Raster bleibt, Vorschaubilder kommen aus dem Bild-Cache
+    if (first != sheetFirst || count != sheetCount) {
+        sheetFirst = (layout(first, count) == EOK) ? first : -1;
+        sheetCount = count;
+    }
+
+    //Raster steht, bevor ein Pixel übertragen ist
+    lcd_wait_idle();
+    GUI_clear(BLACK);
+    for (int k = 0; k < count; k++)
+    {
+        const Thumb *t = &thumbs[k];
+        if (t->ok)
+            fill_rect(t->x, t->y, t->w, t->h, COLOR_PLACEHOLDER);
+        else
+            fill_rect((k % SHEET_COLS) * CELL_WIDTH + CELL_MARGIN, (k / SHEET_COLS) * CELL_HEIGHT + CELL_MARGIN,
+                      CELL_WIDTH - 2 * CELL_MARGIN, CELL_HEIGHT - 2 * CELL_MARGIN, COLOR_UNSUPPORTED);
+    }
+
+    bmp_set_quiet(true);
+    for (int k = 0; k < count; k++)
+    {
+        if (!thumbs[k].ok)
+            continue;
+        bool cached = frame_cache_show(thumbs[k].key);
+        lcd_wait_idle();
+        if (cached)
+            continue;
+        selectFile(first + k);
+        draw_thumb(&thumbs[k]);
+    }
+    bmp_set_quiet(false);
+    return count;
+}
+
+int contact_sheet_cell(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= CELL_WIDTH * SHEET_COLS || y >= CELL_HEIGHT * SHEET_ROWS)
+        return NOK;
+    return (y / CELL_HEIGHT) * SHEET_COLS + x / CELL_WIDTH;
+}
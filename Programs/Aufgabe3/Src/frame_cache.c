@@ -0,0 +1,261 @@
+#include "frame_cache.h"
+#include "lcd_output.h"
+#include <string.h>
+
+/*
+ * Kodierung einer Zeile als Folge von 16-Bit-Worten:
+ *   0x0000          → Zeile wie die vorherige
+ *   0x8000 | n, c   → n Pixel der Farbe c
+ *   n, c1 .. cn     → n einzelne Pixel (1 <= n < 0x8000)
+ * Alle Bilder liegen lückenlos hintereinander in der Arena, die laufende
+ * Aufzeichnung immer am Ende. Beim Verdrängen wird der Rest nach vorne geschoben.
+ */
+#define TOKEN_REPEAT   0x0000u
+#define TOKEN_RUN      0x8000u
+#define MIN_RUN        3 //Kürzere Läufe als Einzelpixel
+#define ARENA_WORDS    (FRAME_CACHE_ARENA_SIZE / 2u)
+#define MAX_LINE_WORDS (2u * FRAME_CACHE_LINE_WIDTH) //Obergrenze einer kodierten Zeile
+
+typedef struct {
+    bool     used;
+    uint32_t key;
+    uint32_t offset;  // erstes Wort in arena
+    uint32_t length;  // Anzahl Worte
+    uint32_t lastUse; // useClock beim letzten Anzeigen → LRU
+    int16_t  firstY;  // LCD-Zeile der ersten (untersten) Zeile
+    int16_t  lines;
+    int16_t  x, w;    // Spalten jeder Zeile (ganze Bilder: 0, FRAME_CACHE_LINE_WIDTH)
+} CacheEntry;
+
+static uint16_t arena[ARENA_WORDS];
+static uint32_t arenaUsed = 0;
+static CacheEntry entries[FRAME_CACHE_MAX_ENTRIES];
+static uint32_t useClock = 0;
+
+//Laufende Aufzeichnung
+static bool     recording = false;
+static uint32_t recStart = 0;
+static int      recFirstY = 0;
+static int      recLines = 0;
+static int      recX = 0;
+static int      recW = FRAME_CACHE_LINE_WIDTH;
+static uint16_t recPrev[FRAME_CACHE_LINE_WIDTH]; //vorherige Zeile für TOKEN_REPEAT
+
+//Anzeige: eine Zeile wird gesendet, in die andere dekodiert
+static uint16_t showLines[2][FRAME_CACHE_LINE_WIDTH];
+
+//Bild aus der Arena entfernen, dahinter liegende Daten (auch die Aufzeichnung) nachrücken
+static void remove_entry(CacheEntry *e)
+{
+    uint32_t end = e->offset + e->length;
+    memmove(&arena[e->offset], &arena[end], (arenaUsed - end) * sizeof(arena[0]));
+
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++)
+    {
+        if (entries[i].used && entries[i].offset > e->offset)
+            entries[i].offset -= e->length;
+    }
+    if (recording && recStart > e->offset)
+        recStart -= e->length;
+
+    arenaUsed -= e->length;
+    e->used = false;
+}
+
+static CacheEntry *least_recently_used(void)
+{
+    CacheEntry *lru = NULL;
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES; i++)
+    {
+        if (entries[i].used && (lru == NULL || entries[i].lastUse < lru->lastUse))
+            lru = &entries[i];
+    }
+    return lru;
+}
+
+//Platz für words Worte schaffen, false wenn selbst eine leere Arena nicht reicht
+static bool make_room(uint32_t words)
+{
+    while (ARENA_WORDS - arenaUsed < words)
+    {
+        CacheEntry *lru = least_recently_used();
+        if (lru == NULL)
+            return false;
+        remove_entry(lru);
+    }
+    return true;
+}
+
+void frame_cache_begin(void)
+{
+    frame_cache_begin_rect(0, FRAME_CACHE_LINE_WIDTH);
+}
+
+void frame_cache_begin_rect(int x, int w)
+{
+    frame_cache_cancel();
+    if (x < 0 || w < 1 || x + w > FRAME_CACHE_LINE_WIDTH)
+        return;
+    recording = true;
+    recStart  = arenaUsed;
+    recLines  = 0;
+    recX      = x;
+    recW      = w;
+}
+
+void frame_cache_cancel(void)
+{
+    if (recording)
+        arenaUsed = recStart;
+    recording = false;
+}
+
+void frame_cache_add_line(int lcdY, const uint16_t *line)
+{
+    if (!recording)
+        return;
+
+    if (recLines == 0) {
+        recFirstY = lcdY;
+    } else if (lcdY != recFirstY - recLines) {
+        frame_cache_cancel(); // Lücke (z.B. Lesefehler beim Hochskalieren) → nicht cachen
+        return;
+    }
+
+    if (!make_room(MAX_LINE_WORDS)) {
+        frame_cache_cancel();
+        return;
+    }
+
+    uint16_t *out = &arena[arenaUsed];
+    uint32_t n = 0;
+
+    if (recLines > 0 && 0 == memcmp(line, recPrev, (size_t)recW * sizeof(recPrev[0])))
+    {
+        out[n++] = TOKEN_REPEAT;
+    }
+    else
+    {
+        int x = 0;
+        while (x < recW)
+        {
+            int run = 1;
+            while (x + run < recW && line[x + run] == line[x])
+                run++;
+
+            if (run >= MIN_RUN)
+            {
+                out[n++] = (uint16_t)(TOKEN_RUN | (uint32_t)run);
+                out[n++] = line[x];
+                x += run;
+                continue;
+            }
+
+            //Einzelpixel bis zum nächsten Lauf
+            int lit = 0;
+            while (x + lit < recW)
+            {
+                const uint16_t *p = line + x + lit;
+                if (x + lit + MIN_RUN <= recW && p[0] == p[1] && p[1] == p[2])
+                    break;
+                lit++;
+            }
+            out[n++] = (uint16_t)lit;
+            memcpy(&out[n], line + x, (size_t)lit * sizeof(out[0]));
+            n += (uint32_t)lit;
+            x += lit;
+        }
+        memcpy(recPrev, line, (size_t)recW * sizeof(recPrev[0]));
+    }
+
+    arenaUsed += n;
+    recLines++;
+}
+
+void frame_cache_commit(uint32_t key)
+{
+    if (!recording || recLines == 0) {
+        frame_cache_cancel();
+        return;
+    }
+
+    //Gleicher Schlüssel ersetzt den alten Eintrag, sonst freien Platz oder LRU verdrängen
+    CacheEntry *slot = NULL;
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES && slot == NULL; i++)
+    {
+        if (entries[i].used && entries[i].key == key)
+            slot = &entries[i];
+    }
+    if (slot != NULL)
+        remove_entry(slot);
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES && slot == NULL; i++)
+    {
+        if (!entries[i].used)
+            slot = &entries[i];
+    }
+    if (slot == NULL) {
+        slot = least_recently_used();
+        remove_entry(slot);
+    }
+
+    slot->used    = true;
+    slot->key     = key;
+    slot->offset  = recStart;
+    slot->length  = arenaUsed - recStart;
+    slot->lastUse = ++useClock;
+    slot->firstY  = (int16_t)recFirstY;
+    slot->lines   = (int16_t)recLines;
+    slot->x       = (int16_t)recX;
+    slot->w       = (int16_t)recW;
+    recording = false;
+}
+
+bool frame_cache_show(uint32_t key)
+{
+    CacheEntry *e = NULL;
+    for (int i = 0; i < FRAME_CACHE_MAX_ENTRIES && e == NULL; i++)
+    {
+        if (entries[i].used && entries[i].key == key)
+            e = &entries[i];
+    }
+    if (e == NULL)
+        return false;
+
+    frame_cache_cancel();
+    e->lastUse = ++useClock;
+
+    const uint16_t *in = &arena[e->offset];
+    int idx = 0;
+    uint16_t *line = showLines[idx];
+
+    for (int y = 0; y < e->lines; y++)
+    {
+        if (*in == TOKEN_REPEAT)
+        {
+            //Wiederholung → dieselbe Zeile noch einmal senden
+            in++;
+        }
+        else
+        {
+            line = showLines[idx];
+            idx ^= 1;
+            int x = 0;
+            while (x < e->w)
+            {
+                uint16_t token = *in++;
+                int count = token & ~TOKEN_RUN;
+                if (token & TOKEN_RUN) {
+                    uint16_t c = *in++;
+                    for (int k = 0; k < count; k++)
+                        line[x + k] = c;
+                } else {
+                    memcpy(&line[x], in, (size_t)count * sizeof(line[0]));
+                    in += count;
+                }
+                x += count;
+            }
+        }
+        lcd_draw_row_async(e->x, e->firstY - y, line, e->w);
+    }
+    return true;
+}
@@ -18,10 +18,16 @@ static bool validHeaders   = false;
       RETURN_NOK_ON_ERR(infoP->biPlanes != 1, "basisChecks: wrong biPlanes (must be 1).");
       RETURN_NOK_ON_ERR(infoP->biHeight < 1, "basisChecks: biHeight must be positive.");
       RETURN_NOK_ON_ERR(infoP->biWidth < 1, "basisChecks: biWidth must be positive.");
-      RETURN_NOK_ON_ERR((8 != infoP->biBitCount) && (24 != infoP->biBitCount), "basisChecks:  wrong biBitCount (must be 8 or 24).");
+      RETURN_NOK_ON_ERR((1 != infoP->biBitCount) && (4 != infoP->biBitCount) && (8 != infoP->biBitCount) && (24 != infoP->biBitCount),
+                        "basisChecks:  wrong biBitCount (must be 1, 4, 8 or 24).");
       RETURN_NOK_ON_ERR((24 == infoP->biBitCount) && (BI_RGB != infoP->biCompression), "basisChecks: 24 bit format cannot be compressed.");
-      RETURN_NOK_ON_ERR((BI_RLE8 != infoP->biCompression) && (BI_RGB != infoP->biCompression), "basisChecks: unexpected compression format.");
+      RETURN_NOK_ON_ERR((BI_RLE8 != infoP->biCompression) && (BI_RLE4 != infoP->biCompression) && (BI_RGB != infoP->biCompression),
+                        "basisChecks: unexpected compression format.");
+      RETURN_NOK_ON_ERR((BI_RLE8 == infoP->biCompression) && (8 != infoP->biBitCount), "basisChecks: RLE8 needs 8 bit/pixel.");
+      RETURN_NOK_ON_ERR((BI_RLE4 == infoP->biCompression) && (4 != infoP->biBitCount), "basisChecks: RLE4 needs 4 bit/pixel.");
       RETURN_NOK_ON_ERR(MAX_COLOR_TABLE_SIZE < infoP->biClrUsed, "basisChecks: biClrUsed out of range.\n");
+      RETURN_NOK_ON_ERR((infoP->biBitCount < 8) && ((1u << infoP->biBitCount) < infoP->biClrUsed),
+                        "basisChecks: biClrUsed exceeds 2^biBitCount.");
       RETURN_NOK_ON_ERR((24 == infoP->biBitCount) && (infoP->biClrUsed != 0), "basisChecks: biClrUsed must be 0 for 24 bit/pixel format.");
    }
    return EOK;
@@ -1,10 +1,12 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include "input.h"
 #include "errorhandler.h"
 #include "lcd.h"
 //#include "perfTimer.h"
 #include "timer.h"
+#include "pipe_stats.h"
 
 #define USE_DMA 
 
@@ -20,32 +22,265 @@
                                  // If all BITMAP files has been transmitted, Python program blocks until new files has been selected
 #define DATA_OUT_CMD       'D'   // Ask Python program to transmit the next data package of the current file 
                                  // An empty data package represents an EOF
+                                 // Windowed protocol: grants one more burst (credit) instead of requesting it
 
-#define BUF_SIZE   512           // Number of bytes of one burst 
+/*
+ * Windowed protocol (optional, negotiated between READY and GO):
+ * The Python program offers WINDOW_IN_CMD followed by 6 hex digits (burst size 4, window 2).
+ * We answer ACCEPT_OUT_CMD with the accepted values in the same format. Afterwards every burst
+ * is sent as sequence number (1 byte) + length (2 bytes) + data, and the Python program may
+ * have up to window bursts on its way: START_OUT_CMD grants window bursts, every DATA_OUT_CMD one more.
+ * Before offering anything the Python program sends HELLO_IN_CMD once more: we answer every
+ * HELLO_IN_CMD with READY_OUT_CMD, an old board ignores it silently (no "Unexpected input cmd").
+ * Only a second READY_OUT_CMD makes the Python program send WINDOW_IN_CMD or PANEL_IN_CMD,
+ * an old board never sees a command it does not know. An old Python program never offers.
+ */
+#define TEXT_OUT_CMD       'T'   // Text line for the Python program (e.g. timing report), terminated by '\n',
+                                 // only sent between files
+#define WINDOW_IN_CMD      'X'   // Offer of burst size and window (6 hex digits), only before GO_IN_CMD
+#define ACCEPT_OUT_CMD     'A'   // Accepted burst size and window (6 hex digits)
+
+/*
+ * Link negotiation (optional, between READY and GO, only after an accepted window offer):
+ * CRC_IN_CMD asks for CRC-protected bursts: sequence number (1 byte) + length (2 bytes)
+ * + CRC32 of the data (4 bytes, big endian) + data. The CRC is computed by the STM32 CRC unit
+ * (polynomial 0x04C11DB7, init 0xFFFFFFFF, 32 bit little endian words, last word padded with 0).
+ * A burst with a wrong sequence number, length or CRC is answered with RETRY_OUT_CMD + its
+ * sequence number (2 hex digits) once the rest of the window has passed, a burst that does
+ * not show up within twice the time of a window, too. Python sends again from this burst on
+ * with a full window (go-back-N). Bursts it had sent before it read RETRY_OUT_CMD and copies
+ * of bursts already received are skipped.
+ *
+ * BAUD_IN_CMD offers a baud rate (8 hex digits). We answer NAK_OUT_CMD if the USART cannot
+ * reach it, otherwise OK_OUT_CMD and switch. Python switches too and sends PROBE_IN_CMD
+ * + PROBE_SIZE pattern bytes. A correct probe is answered with OK_OUT_CMD at the new rate,
+ * otherwise we switch back PROBE_TIMEOUT_MS after our OK_OUT_CMD and answer NAK_OUT_CMD at
+ * the old rate. Python waits a little longer than that for the answer at the new rate.
+ * Python steps up through its rates until a probe fails.
+ */
+#define CRC_IN_CMD         'C'   // Ask for CRC-protected bursts
+#define BAUD_IN_CMD        'B'   // Offer of a baud rate (8 hex digits)
+#define PROBE_IN_CMD       'P'   // Start of the probe pattern, sent at the offered baud rate
+#define OK_OUT_CMD         'K'   // CRC / baud rate offer accepted, probe received correctly
+#define NAK_OUT_CMD        'N'   // Baud rate not possible or probe failed, old baud rate stays
+#define RETRY_OUT_CMD      'E'   // Send again from burst (2 hex digits) on, CRC mode only
+
+/*
+ * Random access (optional, between READY and GO, only after an accepted window offer):
+ * SEEK_IN_CMD announces that Python understands SEEK_OUT_CMD, we answer OK_OUT_CMD.
+ * SEEK_OUT_CMD + offset (8 hex digits) + length (8 hex digits) makes Python send the bytes
+ * [offset, offset + length) of the file of the last START_OUT_CMD like a new file:
+ * sequence numbers from 0, a whole window at once, an empty burst at the end of the range.
+ * It is only sent after the empty burst of the previous file or range or after ABORT_MARK
+ * → no stale bursts.
+ */
+#define SEEK_IN_CMD        'O'   // Python can send parts of the current file again
+#define SEEK_OUT_CMD       'O'   // Send offset (8 hex digits) and length (8 hex digits) of the current file
+
+/*
+ * File list (optional, between READY and GO, only after an accepted window offer):
+ * LIST_IN_CMD + number of files (4 hex digits) announces FILE_OUT_CMD and HEADERS_OUT_CMD,
+ * we answer OK_OUT_CMD. FILE_OUT_CMD + index (4 hex digits) selects the file the next
+ * START_OUT_CMD sends. HEADERS_OUT_CMD + first file (4 hex digits) + count (2 hex digits)
+ * makes Python send the first HEADERS_SIZE bytes of these files (shorter ones padded with 0)
+ * one after another like a single file.
+ */
+#define LIST_IN_CMD        'L'   // Number of files (4 hex digits) in the list of the Python program
+#define FILE_OUT_CMD       'F'   // Next START_OUT_CMD sends this file (4 hex digits)
+#define HEADERS_OUT_CMD    'Y'   // Send the headers of count files from first on (4 + 2 hex digits)
+
+/*
+ * Abort (optional, between READY and GO, only after an accepted window offer):
+ * ABORT_IN_CMD announces that Python understands ABORT_OUT_CMD, we answer OK_OUT_CMD.
+ * ABORT_OUT_CMD makes Python stop the current file (or range) at once. Behind the bursts
+ * already on their way it sends a burst header with length ABORT_MARK and no data
+ * (sequence number and CRC field are not checked). We throw away everything up to it,
+ * the next command can follow immediately.
+ */
+#define ABORT_IN_CMD       'Z'   // Python can stop a file at once
+#define ABORT_OUT_CMD      'Z'   // Stop the current file, answer with ABORT_MARK
+#define ABORT_MARK         0xFFFF // Length of the burst header that ends an aborted file
+
+/*
+ * Sampled rows (optional, between READY and GO, only after an accepted window offer):
+ * SAMPLE_IN_CMD announces that Python understands SAMPLE_OUT_CMD, we answer OK_OUT_CMD.
+ * SAMPLE_OUT_CMD + offset (8 hex digits) + stride (8 hex digits) + pixel size (1 hex digit)
+ * + source width (4 hex digits) + width (4 hex digits) + count (2 hex digits) + count rows
+ * (4 hex digits each) makes Python send, for every listed row r of the current file, the
+ * pixels x = (2 j + 1) * source width / (2 * width), j = 0 .. width - 1, of pixel size bytes
+ * at offset + r * stride + x * pixel size, all rows one after another like a range of
+ * SEEK_OUT_CMD. Pixel size 0 sends the whole rows (stride bytes each) instead.
+ * One request replaces a SEEK_OUT_CMD per row and leaves out the columns in between.
+ */
+#define SAMPLE_IN_CMD      'Q'   // Python can send sampled rows and columns
+#define SAMPLE_OUT_CMD     'Q'   // Send sampled pixels of the listed rows (see above)
+
+/*
+ * Panel (optional, between READY and GO, in the old protocol, too):
+ * PANEL_IN_CMD asks for the geometry of the LCD and the format we decode best. We answer
+ * PANEL_OUT_CMD + width (4 hex digits) + height (4 hex digits) + format (1 char), or NAK_OUT_CMD
+ * after setPanelFit(false). Python may then fit every image into width x height on the PC
+ * and send it in this format, our scaler runs with scale 1. PANEL_FORMAT_RLE8 is a wish:
+ * Python sends PANEL_FORMAT_RGB24 instead where a palette would lose visibly (true colour
+ * photos, large quantization error), the decoder reads both. Senders that do not ask send
+ * the original files and our scaler does all the work as before.
+ */
+#define PANEL_IN_CMD       'V'   // Python can fit the images to the panel
+#define PANEL_OUT_CMD      'V'   // Panel width and height (4 + 4 hex digits) and PANEL_FORMAT
+#define PANEL_FORMAT_RLE8  'P'   // 8 bit palette, BI_RLE8: runs go to the scaler as spans, 1 byte per pixel at most
+#define PANEL_FORMAT_RGB24 'T'   // 24 bit BI_RGB, no palette (there is no 16 bit decoder, see bmp_unsupported)
+#define PANEL_FORMAT       PANEL_FORMAT_RLE8
+
+#define PROBE_SIZE         64    // Number of pattern bytes after PROBE_IN_CMD
+#define PROBE_TIMEOUT_MS   200   // Time to receive the probe at the new baud rate (Python waits 250 ms)
+#define BAUD_TOLERANCE     2     // Largest deviation in % of the USART from the offered rate
+#define BURST_SLACK_MS     100   // Added to twice the time a window needs on the line
+#define MAX_RETRIES        10    // Consecutive broken bursts (sequence number, length, CRC) before giving up
+
+#define BUF_SIZE   512           // Number of bytes of one burst (old protocol)
+#define MAX_BURST_SIZE    2048   // Largest burst size accepted in the windowed protocol
+#define MAX_WINDOW        8      // Largest number of outstanding bursts
+#define PREFETCH_SIZE     (32*1024) // Staging buffer for the start of the next file (prefetchNextFile)
+
+static int burstSize = BUF_SIZE; // negotiated burst size
+static int window = 0;           // negotiated window, 0: old protocol
+static bool crcMode = false;     // bursts carry a CRC32 (windowed protocol only)
+static uint32_t baudRate = 0;    // current baud rate of USART3
+static uint32_t crcErrors = 0;   // bursts with a wrong CRC
+static uint32_t retransmits = 0; // RETRY_OUT_CMDs sent (wrong CRC, sequence number, length or missing burst)
+static bool seekMode = false;    // Python understands SEEK_OUT_CMD
+static int fileCount = 0;        // number of files of the Python program, 0: no FILE_OUT_CMD / HEADERS_OUT_CMD
+static bool abortMode = false;   // Python understands ABORT_OUT_CMD
+static bool sampleMode = false;  // Python understands SAMPLE_OUT_CMD
+static bool panelFit = true;     // answer PANEL_IN_CMD with the geometry (setPanelFit)
+static bool panelMode = false;   // Python asked for the panel geometry and fits the images to it
+static uint32_t filePos = 0;     // position of the next unread byte in the current file
 
 #ifdef USE_DMA
 /*
  * Code for USART RX DMA 
  */
 
+#include <stm32f4xx_hal.h>
 #include <stm32f4xx_ll_bus.h>
+#include <stm32f4xx_ll_crc.h>
 #include <stm32f4xx_ll_dma.h>
 #include <stm32f4xx_ll_usart.h>
 
-// RX ring buffer for RX DMA controller
-#define SIZE_OF_RING_BUFFER         (3*BUF_SIZE)
+// RX ring buffer for RX DMA controller, holds a full window of bursts
+#define SIZE_OF_RING_BUFFER         (4*MAX_BURST_SIZE)
 static char ringBuffer[SIZE_OF_RING_BUFFER];  // ring buffer
 
+// header of a burst: 2 byte length, windowed protocol additionally 1 byte sequence number,
+// CRC mode additionally 4 byte CRC
+static int burstHeaderSize(void){
+   return ((0 != window) ? 3 : 2) + (crcMode ? 4 : 0);
+}
+
+// data of one burst + its header
+static int burstOnWire(void){
+   return burstSize + burstHeaderSize();
+}
+
+// twice the time a whole window needs on the line (8N1: 10 bit per byte) + BURST_SLACK_MS,
+// a longer silence means that Python has paused or a burst got lost
+static uint32_t windowTimeout(void){
+   return (uint32_t)(((0 != window) ? window : 1) * burstOnWire()) * 20000u / baudRate + BURST_SLACK_MS;
+}
+
+/*
+ * Monotonic byte counters of the ring buffer. rxWriteCount will be updated by the DMA
+ * half / full transfer interrupts and before each read.
+ * Because the DMA interrupts occur every half ring, a writer that overtakes the reader
+ * is always visible as rxWriteCount - rxReadCount > SIZE_OF_RING_BUFFER.
+ */
+static volatile uint32_t rxWriteCount = 0; // bytes written by DMA since initInput
+static volatile int rxLastPos = 0;         // DMA write position at last update
+static uint32_t rxReadCount = 0;           // bytes consumed since initInput
+static uint32_t rxRequested = 0;           // upper bound of bytes Python may send (requested bursts)
+static int burstRequestsPending = 0;       // DATA_OUT_CMDs deferred until the ring buffer has room
+static uint8_t rxSeq = 0;                  // expected sequence number of the next burst (windowed protocol)
+static bool firstBurstPending = false;     // START_OUT_CMD sent, first burst of the file not yet received
+static bool retryPending = false;          // RETRY_OUT_CMD sent, burst rxSeq not yet received again
+static volatile uint32_t rxMaxFill = 0;
+static volatile uint32_t rxOverruns = 0;
+
+static int rxReadPos = 0;   // The next read from the DMA ring buffer reads the value from this position
+static int rxAvail   = 0;   // Number of contiguous bytes at rxReadPos known to be written by DMA
+
+/*
+ * Adds the bytes written by DMA since the last call to rxWriteCount.
+ * Called from interrupt context or with interrupts disabled.
+ */
+static void rxUpdate(void){
+   int pos = SIZE_OF_RING_BUFFER - (int) LL_DMA_GetDataLength(DMA1, LL_DMA_STREAM_1);
+   if (SIZE_OF_RING_BUFFER == pos) pos = 0;
+   int delta = pos - rxLastPos;
+   if (delta < 0) delta += SIZE_OF_RING_BUFFER;
+   rxLastPos = pos;
+   rxWriteCount += (uint32_t) delta;
+
+   uint32_t fill = rxWriteCount - rxReadCount;
+   if (fill > rxMaxFill) rxMaxFill = fill;
+   if (fill > SIZE_OF_RING_BUFFER) rxOverruns++;
+}
+
+void DMA1_Stream1_IRQHandler(void){
+   if (LL_DMA_IsActiveFlag_HT1(DMA1)){
+      LL_DMA_ClearFlag_HT1(DMA1);
+   }
+   if (LL_DMA_IsActiveFlag_TC1(DMA1)){
+      LL_DMA_ClearFlag_TC1(DMA1);
+   }
+   rxUpdate();
+}
+
+/*
+ * Returns a pointer to the contiguous bytes already received at rxReadPos.
+ * The DMA counter is only read again if all known bytes have been consumed.
+ */
+static uint32_t rxFill(void){
+   __disable_irq();
+   rxUpdate();
+   uint32_t fill = rxWriteCount - rxReadCount;
+   __enable_irq();
+   return fill;
+}
+
+static int usbUartAvailable(const char **data){
+   if (0 == rxAvail){
+      uint32_t fill = rxFill();
+      LOOP_ON_ERR(fill > SIZE_OF_RING_BUFFER, "usbUartAvailable: RX ring buffer overrun.");
+      int contiguous = SIZE_OF_RING_BUFFER - rxReadPos;
+      rxAvail = ((int) fill < contiguous) ? (int) fill : contiguous;
+   }
+   *data = &ringBuffer[rxReadPos];
+   return rxAvail;
+}
+
+static void usbUartConsume(int n){
+   rxAvail -= n;
+   rxReadCount += (uint32_t) n;
+   rxReadPos += n;
+   if (SIZE_OF_RING_BUFFER == rxReadPos){
+      rxReadPos = 0;
+   }
+}
+
 static int usbUartRead(char *buf, size_t len){
-   // ToDo Check overflow of ring buffer
-   static int nextReadPos = 0; // The next read from the DMA ring buffer reads the value from this position
-   for (int i = 0; i < (int)len; i++){
-      int pos = SIZE_OF_RING_BUFFER - LL_DMA_GetDataLength(DMA1, LL_DMA_STREAM_1); 
-      if (nextReadPos == pos) return (int) i;
-      buf[i] = ringBuffer[nextReadPos];
-      nextReadPos = (nextReadPos + 1) % SIZE_OF_RING_BUFFER;
+   int i = 0;
+   while (i < (int)len){
+      const char *data;
+      int n = usbUartAvailable(&data);
+      if (0 == n) break;
+      if (n > (int)len - i) n = (int)len - i;
+      for (int k = 0; k < n; k++){
+         buf[i + k] = data[k];
+      }
+      usbUartConsume(n);
+      i += n;
    }
-   return (int)len;
+   return i;
 }
 
 static void usbUartWrite(const char *buf, size_t len){
@@ -57,8 +292,8 @@ static void usbUartWrite(const char *buf, size_t len){
 }
 
 static void usbUartDMAInt(void) {
-   /* Peripheral clock enable */
-   LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+   /* Peripheral clock enable (CRC unit checks the bursts in CRC mode) */
+   LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1 | LL_AHB1_GRP1_PERIPH_CRC);
    /* USART3 DMA Init */
    LL_DMA_SetChannelSelection(DMA1, LL_DMA_STREAM_1, LL_DMA_CHANNEL_4);
    LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_STREAM_1, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
@@ -70,23 +305,137 @@ static void usbUartDMAInt(void) {
    LL_DMA_SetMemorySize(DMA1, LL_DMA_STREAM_1, LL_DMA_MDATAALIGN_BYTE);
    LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_1);
    LL_DMA_SetPeriphAddress(DMA1, LL_DMA_STREAM_1, LL_USART_DMA_GetRegAddr(USART3));
-   LL_DMA_SetMemoryAddress(DMA1, LL_DMA_STREAM_1, (uint32_t)ringBuffer);
+   LL_DMA_SetMemoryAddress(DMA1, LL_DMA_STREAM_1, (uint32_t)(uintptr_t)ringBuffer);
    LL_DMA_SetDataLength(DMA1, LL_DMA_STREAM_1, SIZE_OF_RING_BUFFER);
+   /* Half / full transfer interrupts keep rxWriteCount up to date. No USART3 interrupt:
+      USART3_IRQHandler belongs to the CMSIS driver (USART_STM32F4xx.c), reads update anyway. */
+   LL_DMA_EnableIT_HT(DMA1, LL_DMA_STREAM_1);
+   LL_DMA_EnableIT_TC(DMA1, LL_DMA_STREAM_1);
+   NVIC_SetPriority(DMA1_Stream1_IRQn, 5);
+   NVIC_EnableIRQ(DMA1_Stream1_IRQn);
    LL_USART_EnableDMAReq_RX(USART3);
    /* Enable USART and DMA */
    LL_DMA_EnableStream(DMA1, LL_DMA_STREAM_1);
 }
+
+static bool timedOut(uint32_t start, uint32_t ms){
+   return (getTimeStamp() - start) > ms * 1000u * TICKS_PER_US;
+}
+
+/*
+ * Reads len bytes, gives up after ms milliseconds (0: waits forever).
+ * Returns false on timeout, the bytes read so far are consumed.
+ */
+static bool usbUartReadTimeout(char *buf, int len, uint32_t ms){
+   uint32_t start = getTimeStamp();
+   int i = usbUartRead(buf, (size_t) len);
+   if (i < len){
+      PIPE_ENTER(prevStage, PIPE_UART);
+      while ((i < len) && ((0 == ms) || !timedOut(start, ms))){
+         i += usbUartRead(buf + i, (size_t)(len - i));
+      }
+      PIPE_LEAVE(prevStage);
+   }
+   return i == len;
+}
+
+// Waits until n unread bytes are in the ring buffer, false after ms milliseconds
+static bool usbUartWaitFill(int n, uint32_t ms){
+   uint32_t start = getTimeStamp();
+   bool ok = true;
+   PIPE_ENTER(prevStage, PIPE_UART);
+   while (ok && (rxFill() < (uint32_t) n)){
+      ok = !timedOut(start, ms);
+   }
+   PIPE_LEAVE(prevStage);
+   return ok;
+}
+
+// Discards everything received until the line has been idle for ms milliseconds
+static void usbUartDrain(uint32_t ms){
+   uint32_t start = getTimeStamp();
+   while (!timedOut(start, ms)){
+      const char *data;
+      int n = usbUartAvailable(&data);
+      if (0 != n){
+         usbUartConsume(n);
+         start = getTimeStamp();
+      }
+   }
+}
+
+/*
+ * CRC32 of the next len unread bytes by the CRC unit. The unit only takes 32 bit words:
+ * bytes are combined little endian (as a word load would do), the last word is padded with 0.
+ */
+static uint32_t ringBufferCrc(int len){
+   int pos = rxReadPos;
+   LL_CRC_ResetCRCCalculationUnit(CRC);
+   while (len > 0){
+      uint32_t word = 0;
+      int n = (len < 4) ? len : 4;
+      if ((4 == n) && (pos <= SIZE_OF_RING_BUFFER - 4)){
+         memcpy(&word, &ringBuffer[pos], 4);
+         pos += 4;
+      } else {
+         // word wraps around the end of the ring buffer or is the padded last one
+         for (int i = 0; i < n; i++){
+            word |= (uint32_t)(uint8_t) ringBuffer[pos] << (8 * i);
+            if (SIZE_OF_RING_BUFFER == ++pos) pos = 0;
+         }
+      }
+      if (SIZE_OF_RING_BUFFER == pos) pos = 0;
+      LL_CRC_FeedData32(CRC, word);
+      len -= n;
+   }
+   return LL_CRC_ReadData32(CRC);
+}
+
+static uint32_t usartBaudRate(void){
+   return LL_USART_GetBaudRate(USART3, HAL_RCC_GetPCLK1Freq(), LL_USART_GetOverSampling(USART3));
+}
+
+/*
+ * Checks if USART3 (APB1) can run at baud. The divider has a resolution of 1/16 bit
+ * (1/8 with 8 times oversampling) → the USART reaches PCLK1 / round(PCLK1 / baud),
+ * which must not miss baud by more than BAUD_TOLERANCE percent.
+ */
+static bool usartBaudRatePossible(uint32_t baud){
+   uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+   uint32_t minDiv = (LL_USART_OVERSAMPLING_8 == LL_USART_GetOverSampling(USART3)) ? 8u : 16u;
+   if ((0 == baud) || (baud > pclk / minDiv)){
+      return false;
+   }
+   uint32_t reached = pclk / ((pclk + baud / 2u) / baud);
+   uint32_t diff = (reached > baud) ? reached - baud : baud - reached;
+   return diff * 100u <= baud * BAUD_TOLERANCE;
+}
+
+// Switches USART3 to baud, the last byte must have been sent
+static void setUsartBaudRate(uint32_t baud){
+   LL_USART_SetBaudRate(USART3, HAL_RCC_GetPCLK1Freq(), LL_USART_GetOverSampling(USART3), baud);
+   baudRate = baud;
+}
 #endif
 
 /*
  * readChar & writeChar : read / write low level access to UART or local read buffer
  */
+#ifndef USE_DMA
+static uint32_t rxReadCount = 0;   // bytes read since initInput
+#endif
+
 static char readChar(void){
 #ifdef USE_DMA
    char c;
-   while (0 == usbUartRead(&c, 1));
+   if (0 == usbUartRead(&c, 1)){
+      PIPE_ENTER(prevStage, PIPE_UART);
+      while (0 == usbUartRead(&c, 1));
+      PIPE_LEAVE(prevStage);
+   }
    return c;
 #else
+   rxReadCount++;
    return (char) fgetc(stdin);
 #endif
 }
@@ -100,6 +449,23 @@ static void writeChar(int val){
 #endif
 }
 
+#ifdef USE_DMA
+/*
+ * Backpressure: a burst will only be requested if the ring buffer can take it
+ * in addition to all bytes that are unread or still on their way.
+ */
+static void requestNextBurst(void){
+   while (burstRequestsPending > 0){
+      if ((int32_t)(rxRequested - rxReadCount) + burstOnWire() > SIZE_OF_RING_BUFFER){
+         return;  // no room yet, will be retried by consumeSpan
+      }
+      burstRequestsPending--;
+      rxRequested += (uint32_t) burstOnWire();
+      writeChar(DATA_OUT_CMD);  // start transmission of next byte burst
+   }
+}
+#endif
+
 #ifndef USE_DMA
 /*
  * local read buffer that will be for each burst of bytes started by START_OUT_CMD or DATA_OUT_CMD command
@@ -118,93 +484,874 @@ void fillBuf(int size){
 static int nextCharPos = BUF_SIZE;  // next unread element in buffer (BUF_SIZE : alle elems has been consumed)
 static int noElemsInBuf = 0;        // number of elems in buffer; noElemsInBuf == 0 : EOF
 
+/*
+ * FNV-1a hash over the first HEAD_HASH_BYTES bytes of the current file,
+ * updated while the bytes are consumed (identifies the file for the frame cache)
+ */
+static uint32_t headHash = 2166136261u;
+static int headHashed = 0;           // number of bytes in headHash
+static bool headAtEof = false;       // file ended before HEAD_HASH_BYTES bytes
+
+static void updateHeadHash(const char *data, int n){
+   if (n > HEAD_HASH_BYTES - headHashed){
+      n = HEAD_HASH_BYTES - headHashed;
+   }
+   for (int i = 0; i < n; i++){
+      headHash ^= (uint8_t) data[i];
+      headHash *= 16777619u;
+   }
+   headHashed += n;
+}
+
+static int readHex(int digits){
+   int val = 0;
+   for (int i = 0; i < digits; i++){
+      char c = (char) readChar();
+      int d;
+      if ((c >= '0') && (c <= '9'))      d = c - '0';
+      else if ((c >= 'A') && (c <= 'F')) d = c - 'A' + 10;
+      else return -1;
+      val = (val << 4) | d;
+   }
+   return val;
+}
+
+static void writeHex(uint32_t val, int digits){
+   for (int i = digits - 1; i >= 0; i--){
+      writeChar("0123456789ABCDEF"[(val >> (4 * i)) & 0xF]);
+   }
+}
+
+/**
+* @brief Handles WINDOW_IN_CMD: reads the offer and answers with the accepted values.
+*        Without DMA there is no room for more than one burst → no answer, old protocol.
+*/
+static void negotiateWindow(void){
+   int offerBurst  = readHex(4);
+   int offerWindow = readHex(2);
+   if ((offerBurst <= 0) || (offerWindow <= 0)){
+      lcdPrintS("Invalid window offer received.");
+      return;
+   }
+#ifdef USE_DMA
+   int b = (offerBurst < MAX_BURST_SIZE) ? offerBurst : MAX_BURST_SIZE;
+   int w = (offerWindow < MAX_WINDOW) ? offerWindow : MAX_WINDOW;
+   if (w * (b + 7) > SIZE_OF_RING_BUFFER){
+      w = SIZE_OF_RING_BUFFER / (b + 7);  // room for the header of CRC mode, too
+   }
+   burstSize = b;
+   window = w;
+   writeChar(ACCEPT_OUT_CMD);
+   writeHex((uint32_t) burstSize, 4);
+   writeHex((uint32_t) window, 2);
+#endif
+}
+
+/**
+* @brief Handles CRC_IN_CMD: CRC-protected bursts need the sequence numbers of the windowed protocol.
+*/
+static void negotiateCrc(void){
+#ifdef USE_DMA
+   if (0 != window){
+      crcMode = true;
+      writeChar(OK_OUT_CMD);
+      return;
+   }
+#endif
+   writeChar(NAK_OUT_CMD);
+}
+
+/**
+* @brief Handles SEEK_IN_CMD: a range starts with a whole window like a new file.
+*/
+static void negotiateSeek(void){
+   if (0 != window){
+      seekMode = true;
+      writeChar(OK_OUT_CMD);
+      return;
+   }
+   writeChar(NAK_OUT_CMD);
+}
+
+/**
+* @brief Handles LIST_IN_CMD: files are selected and their headers requested while the
+*        bursts of the previous file may still be on their way → window needed (stopFile).
+*/
+static void negotiateList(void){
+   int count = readHex(4);
+   if ((0 != window) && (count > 0)){
+      fileCount = count;
+      writeChar(OK_OUT_CMD);
+      return;
+   }
+   writeChar(NAK_OUT_CMD);
+}
+
+/**
+* @brief Handles ABORT_IN_CMD: ABORT_MARK is a burst header → windowed protocol needed.
+*/
+static void negotiateAbort(void){
+   if (0 != window){
+      abortMode = true;
+      writeChar(OK_OUT_CMD);
+      return;
+   }
+   writeChar(NAK_OUT_CMD);
+}
+
+/**
+* @brief Handles SAMPLE_IN_CMD: the sampled pixels come like a range (negotiateSeek).
+*/
+static void negotiateSample(void){
+   if (0 != window){
+      sampleMode = true;
+      writeChar(OK_OUT_CMD);
+      return;
+   }
+   writeChar(NAK_OUT_CMD);
+}
+
+/**
+* @brief Handles PANEL_IN_CMD: needs no window, the images only get smaller.
+*/
+static void negotiatePanel(void){
+   if (!panelFit){
+      writeChar(NAK_OUT_CMD);
+      return;
+   }
+   panelMode = true;
+   writeChar(PANEL_OUT_CMD);
+   writeHex(PANEL_WIDTH, 4);
+   writeHex(PANEL_HEIGHT, 4);
+   writeChar(PANEL_FORMAT);
+}
+
+#ifdef USE_DMA
+static bool probeValid(const char *probe){
+   for (int i = 0; i < PROBE_SIZE; i++){
+      if ((uint8_t) probe[i] != (uint8_t)((i * 0x3B) ^ 0x55)){
+         return false;
+      }
+   }
+   return true;
+}
+#endif
+
+/**
+* @brief Handles BAUD_IN_CMD: switches to the offered baud rate and keeps it if the probe
+*        arrives correctly, otherwise returns to the old rate after PROBE_TIMEOUT_MS.
+*        A failed probe is not answered before the timeout, so Python is back at the old rate.
+*/
+static void negotiateBaud(void){
+   int offer = readHex(8);
+#ifdef USE_DMA
+   if ((offer <= 0) || !usartBaudRatePossible((uint32_t) offer)){
+      writeChar(NAK_OUT_CMD);
+      return;
+   }
+   uint32_t oldBaud = baudRate;
+   writeChar(OK_OUT_CMD);  // returns after the stop bit has been sent
+   setUsartBaudRate((uint32_t) offer);
+
+   // one deadline for marker and pattern: the answer must be out before Python gives up
+   uint32_t start = getTimeStamp();
+   bool ok = false;
+   while (!ok && !timedOut(start, PROBE_TIMEOUT_MS)){
+      char c;
+      if ((1 == usbUartRead(&c, 1)) && (PROBE_IN_CMD == c)){
+         uint32_t elapsedMs = (getTimeStamp() - start) / (1000u * TICKS_PER_US);
+         char probe[PROBE_SIZE];
+         ok = (elapsedMs < PROBE_TIMEOUT_MS) &&
+              usbUartReadTimeout(probe, PROBE_SIZE, PROBE_TIMEOUT_MS - elapsedMs) && probeValid(probe);
+      }
+   }
+   if (!ok){
+      setUsartBaudRate(oldBaud);
+   }
+   writeChar(ok ? OK_OUT_CMD : NAK_OUT_CMD);
+#else
+   (void) offer;
+   writeChar(NAK_OUT_CMD);
+#endif
+}
+
 void initInput(void){
 #ifdef USE_DMA
    usbUartDMAInt();
+#endif
+   burstSize = BUF_SIZE;
+   window = 0;
+   crcMode = false;
+   seekMode = false;
+   fileCount = 0;
+   abortMode = false;
+   sampleMode = false;
+   panelMode = false;
+#ifdef USE_DMA
+   baudRate = usartBaudRate();
 #endif
    char ch;
    // wait for hello
    while (HELLO_IN_CMD != (char) readChar()){};
    // got first hello
    writeChar(READY_OUT_CMD);
-   // Yet some other Hello cmds might be in output buffer of Python programs (e.g. due to long wait)
+   // Yet some other Hello cmds might be in output buffer of Python programs (e.g. due to long wait),
+   // every one is answered: a second READY_OUT_CMD tells the Python program that we negotiate
    do {
       ch = (char)readChar();
-      if((HELLO_IN_CMD != ch) && (GO_IN_CMD != ch)){
+      if (HELLO_IN_CMD == ch){
+         writeChar(READY_OUT_CMD);
+      } else if (WINDOW_IN_CMD == ch){
+         negotiateWindow();
+      } else if (CRC_IN_CMD == ch){
+         negotiateCrc();
+      } else if (BAUD_IN_CMD == ch){
+         negotiateBaud();
+      } else if (SEEK_IN_CMD == ch){
+         negotiateSeek();
+      } else if (LIST_IN_CMD == ch){
+         negotiateList();
+      } else if (ABORT_IN_CMD == ch){
+         negotiateAbort();
+      } else if (SAMPLE_IN_CMD == ch){
+         negotiateSample();
+      } else if (PANEL_IN_CMD == ch){
+         negotiatePanel();
+      } else if(GO_IN_CMD != ch){
          lcdPrintS("Unexpected input cmd received.");
       }
    } while (GO_IN_CMD != ch);
 }
 
+#ifdef USE_DMA
+// Throws away the next len bytes, false if they do not arrive within ms milliseconds
+static bool usbUartSkip(int len, uint32_t ms){
+   if (!usbUartWaitFill(len, ms)){
+      return false;
+   }
+   while (len > 0){
+      const char *data;
+      int n = usbUartAvailable(&data);
+      if (n > len) n = len;
+      usbUartConsume(n);
+      len -= n;
+   }
+   return true;
+}
+
+/*
+ * CRC mode: a burst with another sequence number than rxSeq that is no error. After
+ * RETRY_OUT_CMD Python may still send bursts granted before (it paused while we waited),
+ * after them comes the retransmit with copies of bursts we might have taken already.
+ */
+static bool staleBurst(uint8_t seq){
+   uint8_t behind = (uint8_t)(rxSeq - seq);
+   return retryPending || ((0 != behind) && (behind <= window));
+}
+
+typedef enum {
+   BURST_OK,       // sequence number, length and CRC correct, the data is unread in the ring buffer
+   BURST_BROKEN,   // wrong sequence number, length or CRC, or the burst stopped halfway
+   BURST_MISSING   // nothing arrived within windowTimeout: Python paused or the burst got lost
+} BurstCheck;
+
+/**
+* @brief CRC mode: reads the header of the next burst and waits for all of its data.
+*        Stale bursts (staleBurst) are skipped.
+* @param waitForever  The burst answers START_OUT_CMD, Python may wait for a new file
+*/
+static BurstCheck readCheckedBurst(bool waitForever){
+   uint32_t timeout = windowTimeout();
+   char header[7];
+   while (true){
+      if (!usbUartReadTimeout(header, 1, waitForever ? 0 : timeout)){
+         return BURST_MISSING;
+      }
+      if (!usbUartReadTimeout(header + 1, 6, timeout)){
+         return BURST_BROKEN;
+      }
+      noElemsInBuf = ((uint8_t) header[1] << 8) | (uint8_t) header[2];
+      if (noElemsInBuf > burstSize){
+         return BURST_BROKEN;
+      }
+      if ((uint8_t) header[0] == rxSeq){
+         break;
+      }
+      if (!staleBurst((uint8_t) header[0]) || !usbUartSkip(noElemsInBuf, timeout)){
+         return BURST_BROKEN;
+      }
+      rxRequested += (uint32_t)(burstHeaderSize() + noElemsInBuf);  // was not part of the requested window
+   }
+   uint32_t crc = ((uint32_t)(uint8_t) header[3] << 24) | ((uint32_t)(uint8_t) header[4] << 16) |
+                  ((uint32_t)(uint8_t) header[5] << 8)  |  (uint32_t)(uint8_t) header[6];
+   if (!usbUartWaitFill(noElemsInBuf, timeout)){
+      return BURST_BROKEN;
+   }
+   if (ringBufferCrc(noElemsInBuf) != crc){
+      crcErrors++;
+      return BURST_BROKEN;
+   }
+   retryPending = false;
+   return BURST_OK;
+}
+
+/**
+* @brief CRC mode: asks Python to send again from burst rxSeq on (go-back-N).
+*/
+static void requestRetry(void){
+   // no more credits: Python stops after the bursts already granted, they are thrown away
+   // until the line has been quiet for as long as a window takes
+   burstRequestsPending = 0;
+   usbUartDrain(windowTimeout());
+   writeChar(RETRY_OUT_CMD);
+   writeHex(rxSeq, 2);
+   retransmits++;
+   retryPending = true;
+   // Python starts again with a whole window like after START_OUT_CMD
+   rxRequested = rxReadCount + (uint32_t)(window * burstOnWire());
+}
+
+/**
+* @brief Stops the current file by ABORT_OUT_CMD and throws away the bursts on their way up
+*        to ABORT_MARK. If it does not show up in time (broken burst header), waits until the
+*        line has been quiet for windowTimeout instead.
+* @param inBurst  Unread data bytes of the current burst in the ring buffer
+*/
+static void abortTransfer(int inBurst){
+   uint32_t timeout = (uint32_t) burstOnWire() * 20000u / baudRate + BURST_SLACK_MS;
+   int headerSize = burstHeaderSize();
+   burstRequestsPending = 0;
+   writeChar(ABORT_OUT_CMD);
+   bool framed = usbUartSkip(inBurst, timeout);
+   while (framed){
+      char header[7];
+      if (!usbUartReadTimeout(header, headerSize, timeout)){
+         break;
+      }
+      int len = ((uint8_t) header[1] << 8) | (uint8_t) header[2];
+      if (ABORT_MARK == len){
+         return;
+      }
+      framed = (len <= burstSize) && usbUartSkip(len, timeout);
+   }
+   usbUartDrain(windowTimeout());
+}
+
+/**
+* @brief CRC mode: receives the next burst. A broken or missing burst is requested again
+*        with all following ones, its data never reaches nextSpan. Only broken bursts count
+*        towards MAX_RETRIES, a missing one may just be a pause of Python.
+*/
+static void receiveCheckedBurst(void){
+   int retries = 0;
+   bool retried = false;
+   BurstCheck check;
+   // the first burst answers START_OUT_CMD, Python may wait for a new file
+   while (BURST_OK != (check = readCheckedBurst(firstBurstPending && !retried))){
+      if (BURST_BROKEN == check){
+         retries++;
+         LOOP_ON_ERR(retries > MAX_RETRIES, "receiveCheckedBurst: Too many broken bursts.");
+      }
+      requestRetry();
+      retried = true;
+   }
+   firstBurstPending = false;
+   rxSeq++;
+   rxRequested -= (uint32_t)(burstSize - noElemsInBuf);  // burst is shorter than reserved
+   if (0 != noElemsInBuf){
+      burstRequestsPending++;  // grant one more
+      requestNextBurst();
+   }
+}
+#endif
+
+// START_OUT_CMD / SEEK_OUT_CMD request one burst, in the windowed protocol a whole window
+static void expectFirstBurst(void){
+#ifdef USE_DMA
+   rxRequested = rxReadCount + (uint32_t)(((0 != window) ? window : 1) * burstOnWire());
+   burstRequestsPending = 0;
+   rxSeq = 0;
+   firstBurstPending = true;
+   retryPending = false;
+#endif
+}
+
+static void requestFile(void){
+   expectFirstBurst();
+   filePos = 0;
+   writeChar(START_OUT_CMD);
+}
+
 /**
 * @brief This function will be called when all byte of current byte burst has been consumed
 *
-* @param openNewFile  A new file should be opened
+* @param requested  START_OUT_CMD or SEEK_OUT_CMD has been sent, the first burst is on its way
 * @retval None
 */
-static void startNextByteBurst(bool openNewFile){
-   // Ask for data package
-   if (openNewFile){
-      writeChar(START_OUT_CMD);
-   }
+static void startNextByteBurst(bool requested){
 #ifndef USE_DMA
-   if (!openNewFile){
+   // Ask for data package
+   if (!requested){
       writeChar(DATA_OUT_CMD);
    }
+#else
+   (void) requested;
+   requestNextBurst();  // a deferred request must be on its way before we wait for its length
+   if (crcMode){
+      receiveCheckedBurst();
+      nextCharPos = 0;
+      return;
+   }
+#endif
+#ifdef USE_DMA
+   if (0 != window){
+      // bursts of the windowed protocol are numbered, a gap means lost or stale data
+      uint8_t seq = (uint8_t) readChar();
+      LOOP_ON_ERR(seq != rxSeq, "startNextByteBurst: Burst out of sequence.");
+      rxSeq++;
+   }
 #endif
    // read no of data that will be transmitted
    noElemsInBuf = (((char) readChar())& 0xff) << 8;
    noElemsInBuf = noElemsInBuf | (((char) readChar())& 0xff);
 #ifdef USE_DMA
+   if (noElemsInBuf <= burstSize){
+      rxRequested -= (uint32_t)(burstSize - noElemsInBuf);  // burst is shorter than reserved
+   }
    if (0 != noElemsInBuf){
-      writeChar(DATA_OUT_CMD);  // start transmission of next byte burst
+      burstRequestsPending++;  // old protocol: request next burst, windowed: grant one more
+      requestNextBurst();
    }
 #endif
-   LOOP_ON_ERR(noElemsInBuf > BUF_SIZE, "startNextByteBurst: To many input data.");
+   LOOP_ON_ERR(noElemsInBuf > burstSize, "startNextByteBurst: To many input data.");
 #ifndef USE_DMA  
    fillBuf(noElemsInBuf);
 #endif
    nextCharPos = 0;
 }
 
-int nextChar(void){
+#ifdef USE_DMA
+/*
+ * Prefetch of the next file (slideshow): while an image is shown, the complete bursts of the
+ * next file are moved from the ring buffer into stage, each one grants the next. When stage is
+ * full, no more bursts are granted and the ones on their way wait in the ring buffer.
+ * openNextFile then serves stage like one long burst and continues with the ring buffer.
+ */
+static char stage[PREFETCH_SIZE];
+static int stageLen = 0;          // bytes of the next file in stage
+static bool stageEof = false;     // EOF burst of the next file is in stage
+static bool prefetching = false;  // START_OUT_CMD for the next file has been sent by prefetchNextFile
+static bool fromStage = false;    // the current burst (noElemsInBuf, nextCharPos) is stage
+static int stageRetries = 0;      // consecutive broken bursts while prefetching (CRC mode)
+
+static uint8_t ringPeek(int offset){
+   return (uint8_t) ringBuffer[(rxReadPos + offset) % SIZE_OF_RING_BUFFER];
+}
+
+/**
+* @brief Moves the next burst into stage if it has been received completely. Never waits,
+*        except for the idle line before a retransmit request in CRC mode.
+* @retval true if another burst may follow at once, false if it is still on its way,
+*         stage is full or the file has ended
+*/
+static bool stageBurst(void){
+   int headerSize = burstHeaderSize();
+   int lenPos = (0 != window) ? 1 : 0;
+   if (stageEof || (stageLen + burstSize > PREFETCH_SIZE) || (rxFill() < (uint32_t) headerSize)){
+      return false;
+   }
+   int len = (ringPeek(lenPos) << 8) | ringPeek(lenPos + 1);
+   if ((len <= burstSize) && (rxFill() < (uint32_t)(headerSize + len))){
+      return false;
+   }
+
+   char header[7];
+   usbUartRead(header, (size_t) headerSize);
+   if (crcMode && (len <= burstSize) && ((uint8_t) header[0] != rxSeq) && staleBurst((uint8_t) header[0])){
+      usbUartSkip(len, 0);  // complete in the ring buffer
+      rxRequested += (uint32_t)(headerSize + len);
+      return true;
+   }
+   bool ok = (len <= burstSize) && ((0 == window) || ((uint8_t) header[0] == rxSeq));
+   if (ok && crcMode){
+      uint32_t crc = ((uint32_t)(uint8_t) header[3] << 24) | ((uint32_t)(uint8_t) header[4] << 16) |
+                     ((uint32_t)(uint8_t) header[5] << 8)  |  (uint32_t)(uint8_t) header[6];
+      ok = (ringBufferCrc(len) == crc);
+      if (!ok) crcErrors++;
+   }
+   if (!ok){
+      LOOP_ON_ERR(!crcMode, "stageBurst: Burst out of sequence or too long.");
+      stageRetries++;
+      LOOP_ON_ERR(stageRetries > MAX_RETRIES, "stageBurst: Too many broken bursts.");
+      requestRetry();
+      return true;
+   }
+   stageRetries = 0;
+   retryPending = false;
+
+   usbUartRead(&stage[stageLen], (size_t) len);
+   stageLen += len;
+   if (0 != window){
+      rxSeq++;
+   }
+   firstBurstPending = false;
+   rxRequested -= (uint32_t)(burstSize - len);  // burst is shorter than reserved
+   if (0 == len){
+      stageEof = true;
+      return false;
+   }
+   burstRequestsPending++;  // old protocol: request next burst, windowed: grant one more
+   requestNextBurst();
+   return true;
+}
+#endif
+
+void prefetchNextFile(void){
+#ifdef USE_DMA
+   if (prefetching){
+      return;
+   }
+   // the rest of the current file (at least its EOF burst) must be read before START_OUT_CMD
+   const char *data;
+   int n;
+   while (0 != (n = nextSpan(&data))){
+      consumeSpan(n);
+   }
+   fromStage = false;
+   stageLen = 0;
+   stageEof = false;
+   stageRetries = 0;
+   prefetching = true;
+   requestFile();
+#endif
+}
+
+bool prefetchPoll(void){
+#ifdef USE_DMA
+   if (prefetching){
+      while (stageBurst());
+      return !stageEof && (stageLen + burstSize <= PREFETCH_SIZE);
+   }
+#endif
+   return false;
+}
+
+int nextSpan(const char **data){
    if(0 == noElemsInBuf){
-      return EOF;
+      return 0;  // EOF, or stopped by stopFile
    }
-   if((noElemsInBuf == nextCharPos) || (BUF_SIZE == nextCharPos)){
+   if(noElemsInBuf == nextCharPos){
       // start next byte burst
+#ifdef USE_DMA
+      if (fromStage && stageEof){
+         noElemsInBuf = 0;  // prefetched file has ended in stage
+      } else {
+         fromStage = false;
+         startNextByteBurst(false);
+      }
+#else
       startNextByteBurst(false);
+#endif
    }
    if(0 == noElemsInBuf){
-      return EOF;
+      if (filePos == (uint32_t) headHashed){
+         headAtEof = true;  // not at the end of a range that started behind the head
+      }
+      return 0;
    }
+   int inBurst = noElemsInBuf - nextCharPos;
 #ifdef USE_DMA
-   nextCharPos++;
-   char c = readChar();
-   return (int)c;
-#else 
-   return buf[nextCharPos++];
+   if (fromStage){
+      *data = &stage[nextCharPos];
+      return inBurst;
+   }
+   int n = usbUartAvailable(data);
+   if (0 == n){
+      PIPE_ENTER(prevStage, PIPE_UART);
+      while (0 == (n = usbUartAvailable(data)));
+      PIPE_LEAVE(prevStage);
+   }
+   return (n < inBurst) ? n : inBurst;
+#else
+   *data = &buf[nextCharPos];
+   return inBurst;
+#endif
+}
+
+void consumeSpan(int n){
+   // only the head of the file as it arrived first, not a range after seekFile
+   if ((headHashed < HEAD_HASH_BYTES) && (filePos == (uint32_t) headHashed)){
+#ifdef USE_DMA
+      updateHeadHash(fromStage ? &stage[nextCharPos] : &ringBuffer[rxReadPos], n);
+#else
+      updateHeadHash(&buf[nextCharPos], n);
+#endif
+   }
+   nextCharPos += n;
+   filePos += (uint32_t) n;
+#ifdef USE_DMA
+   if (!fromStage){
+      usbUartConsume(n);
+      requestNextBurst();
+   }
 #endif
 }
 
+int nextChar(void){
+   const char *data;
+   if (0 == nextSpan(&data)){
+      return EOF;
+   }
+   char c = data[0];
+   consumeSpan(1);
+   return (int)c;
+}
+
 void openNextFile(void){
+   headHash = 2166136261u;
+   headHashed = 0;
+   headAtEof = false;
 #ifdef USE_DMA
+   if (prefetching){
+      // START_OUT_CMD has been sent already, read stage first
+      prefetchPoll();
+      prefetching = false;
+      fromStage = (0 != stageLen) || stageEof;
+      if (fromStage){
+         noElemsInBuf = stageLen;
+         nextCharPos = 0;
+      } else {
+         startNextByteBurst(true);
+      }
+      return;
+   }
+   fromStage = false;
+   if (abortMode){
+      stopFile();  // the rest of a rejected or partly read file is not sent any more
+   }
    // clear DMA ring buffer
    char c;
    while (0 != usbUartRead(&c, 1));
 #endif
+   requestFile();
    startNextByteBurst(true);
 }
 
+int seekFile(uint32_t offset, uint32_t length){
+#ifdef USE_DMA
+   if (!seekMode || prefetching){
+      return NOK;
+   }
+#else
+   if (!seekMode){
+      return NOK;
+   }
+#endif
+   // the rest of the current file or range (at least its EOF burst) must be gone before SEEK_OUT_CMD
+   if (abortMode){
+      stopFile();
+   } else {
+      const char *data;
+      int n;
+      while (0 != (n = nextSpan(&data))){
+         consumeSpan(n);
+      }
+   }
+#ifdef USE_DMA
+   fromStage = false;
+#endif
+   expectFirstBurst();
+   writeChar(SEEK_OUT_CMD);
+   writeHex(offset, 8);
+   writeHex(length, 8);
+   filePos = offset;
+   startNextByteBurst(true);
+   return EOK;
+}
+
+int sampleRows(uint32_t offset, uint32_t stride, int pixelSize, int srcWidth, int width,
+               const uint16_t *rows, int count){
+#ifdef USE_DMA
+   if (!sampleMode || prefetching){
+      return NOK;
+   }
+#else
+   if (!sampleMode){
+      return NOK;
+   }
+#endif
+   if ((pixelSize < 0) || (pixelSize > 0xF) || (srcWidth <= 0) || (srcWidth > 0xFFFF) ||
+       (width <= 0) || (width > 0xFFFF) || (count <= 0) || (count > 0xFF)){
+      return NOK;
+   }
+   // like seekFile: no bursts of the current file or range may be left
+   if (abortMode){
+      stopFile();
+   } else {
+      const char *data;
+      int n;
+      while (0 != (n = nextSpan(&data))){
+         consumeSpan(n);
+      }
+   }
+#ifdef USE_DMA
+   fromStage = false;
+#endif
+   expectFirstBurst();
+   writeChar(SAMPLE_OUT_CMD);
+   writeHex(offset, 8);
+   writeHex(stride, 8);
+   writeHex((uint32_t) pixelSize, 1);
+   writeHex((uint32_t) srcWidth, 4);
+   writeHex((uint32_t) width, 4);
+   writeHex((uint32_t) count, 2);
+   for (int i = 0; i < count; i++){
+      writeHex(rows[i], 4);
+   }
+   // the pixels are no consecutive part of the file → not hashed, no head hash for this file
+   filePos = offset + rows[0] * stride;
+   if (headHashed < HEAD_HASH_BYTES){
+      headHashed = -1;
+   }
+   startNextByteBurst(true);
+   return EOK;
+}
+
+uint32_t getFilePos(void){
+   return filePos;
+}
+
+void stopFile(void){
+#ifdef USE_DMA
+   if (prefetching){
+      return;
+   }
+   if (0 != noElemsInBuf){
+      if (abortMode){
+         abortTransfer(fromStage ? 0 : noElemsInBuf - nextCharPos);
+      } else {
+         // no more credits: Python stops after the bursts already granted, they are thrown away
+         burstRequestsPending = 0;
+         usbUartDrain(windowTimeout());
+      }
+   }
+   fromStage = false;
+#endif
+   // old protocol without DMA: the next burst is only sent after DATA_OUT_CMD
+   noElemsInBuf = 0;
+   nextCharPos = 0;
+}
+
+void setPanelFit(bool fit){
+   panelFit = fit;
+}
+
+int getFileCount(void){
+   return fileCount;
+}
+
+int selectFile(int index){
+   if ((0 == fileCount) || (index < 0)){
+      return NOK;
+   }
+   stopFile();
+   writeChar(FILE_OUT_CMD);
+   writeHex((uint32_t)(index % fileCount), 4);
+   return EOK;
+}
+
+int openHeaders(int first, int count){
+   if ((0 == fileCount) || (first < 0) || (count <= 0) || (count > 0xFF)){
+      return NOK;
+   }
+   stopFile();
+   headHash = 2166136261u;
+   headHashed = 0;
+   headAtEof = false;
+   expectFirstBurst();
+   filePos = 0;
+   writeChar(HEADERS_OUT_CMD);
+   writeHex((uint32_t)(first % fileCount), 4);
+   writeHex((uint32_t) count, 2);
+   startNextByteBurst(true);
+   return EOK;
+}
+
+bool getHeadHash(uint32_t *hash){
+   if (headHashed < HEAD_HASH_BYTES && !headAtEof){
+      return false;
+   }
+   *hash = headHash;
+   return true;
+}
+
+void sendText(const char *text){
+   writeChar(TEXT_OUT_CMD);
+   for (; '\0' != *text; text++){
+      writeChar(('\n' == *text) ? ' ' : *text);
+   }
+   writeChar('\n');
+}
+
+void getInputStats(InputStats *stats){
+#ifdef USE_DMA
+   __disable_irq();
+   rxUpdate();
+   stats->bytesReceived = rxWriteCount;
+   stats->maxFill       = rxMaxFill;
+   stats->overruns      = rxOverruns;
+   __enable_irq();
+#else
+   stats->bytesReceived = rxReadCount;
+   stats->maxFill       = 0;
+   stats->overruns      = 0;
+#endif
+   stats->baudRate      = baudRate;
+   stats->crcMode       = crcMode;
+   stats->crcErrors     = crcErrors;
+   stats->retransmits   = retransmits;
+#ifdef USE_DMA
+   stats->prefetched    = fromStage ? (uint32_t) stageLen : 0;
+#else
+   stats->prefetched    = 0;
+#endif
+   stats->seekMode      = seekMode;
+   stats->abortMode     = abortMode;
+   stats->sampleMode    = sampleMode;
+   stats->panelMode     = panelMode;
+   stats->burstSize     = (uint32_t) burstSize;
+   stats->window        = (uint32_t) window;
+}
+
 int COMread(char* buf, unsigned int size, unsigned int count){
-   for (unsigned int i = 0; i < size * count; i++){
-      int c = nextChar();
-      if (EOF == c) {
+   unsigned int total = size * count;
+   unsigned int done = 0;
+   while (done < total){
+      const char *data;
+      unsigned int n = (unsigned int) nextSpan(&data);
+      if (0 == n) {
          return EOF;
       }
-      buf[i] = (char) c;
+      if (n > total - done) n = total - done;
+      memcpy(buf + done, data, n);
+      consumeSpan((int) n);
+      done += n;
    }
    return count;
 }
 
+int COMskip(unsigned int n){
+   while (n > 0){
+      const char *data;
+      unsigned int avail = (unsigned int) nextSpan(&data);
+      if (0 == avail) {
+         return EOF;
+      }
+      if (avail > n) avail = n;
+      consumeSpan((int) avail);
+      n -= avail;
+   }
+   return EOK;
+}
+
 //EOF
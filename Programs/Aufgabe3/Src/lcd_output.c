@@ -1,5 +1,128 @@
 #include "lcd_output.h"
 #include "LCD_GUI.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+static volatile LcdRowDoneCallback rowDoneCb = NULL;
+
+#if LCD_ASYNC_OUTPUT
+#include "stm32f4xx_hal.h"
+#include <stm32f4xx_ll_bus.h>
+#include <stm32f4xx_ll_dma.h>
+
+/*
+ * Verdrahtung des Waveshare-Shields am Arduino-Header des Nucleo-144:
+ * SPI1 (D11/D13), LCD_CS = D10 (PD14), LCD_DC = D7 (PF13).
+ * SPI1_TX liegt auf DMA2 Stream 3, Kanal 3.
+ */
+#define LCD_CS_PORT   GPIOD
+#define LCD_CS_PIN    14
+#define LCD_DC_PORT   GPIOF
+#define LCD_DC_PIN    13
+
+#define LCD_CMD_COLUMN_ADDR  0x2A
+#define LCD_CMD_PAGE_ADDR    0x2B
+#define LCD_CMD_MEMORY_WRITE 0x2C
+#define LCD_CMD_MEMORY_CONT  0x3C //Write Memory Continue: schreibt ab der Adresse nach dem letzten Pixel weiter
+#define LCD_CMD_MEMORY_ACCESS 0x36 //MADCTL
+
+/*
+ * BMP-Zeilen kommen von unten nach oben. Mit umgekehrter Seitenadress-Reihenfolge (MADCTL MY)
+ * reicht ein Adressfenster von der ersten Zeile bis zum oberen Rand, jede weitere Zeile
+ * folgt mit Write Memory Continue (1 Byte statt Seitenbereich + Write Memory, 6 Byte).
+ * LCD_MADCTL_DEFAULT ist der Wert, den LCD_Init für das Querformat setzt (MV | BGR);
+ * lcd_wait_idle stellt ihn wieder her, bevor GUI_* zeichnet.
+ */
+#define LCD_MADCTL_DEFAULT   0x28
+#define LCD_MADCTL_ROW_FLIP  0x80 //MY: Seitenadressen laufen von unten nach oben
+
+static volatile bool rowBusy = false;
+static volatile int rowRepeats = 0; //lcd_draw_rows_async: so oft wird der Puffer noch gesendet
+static uint32_t rowWidth = 0;        //Pixel pro gesendeter Zeile
+static int colX = -1;                //Im LCD eingestellter Spaltenbereich (-1: unbekannt, GUI_* kann ihn ändern)
+static int colW = 0;
+static bool rowFlip = false;         //MADCTL mit LCD_MADCTL_ROW_FLIP gesetzt
+static int nextRowY = -1;            //Zeile, die Write Memory Continue als nächste beschreibt (-1: kein Fenster offen)
+
+static inline void pinLow(GPIO_TypeDef *port, int pin)  { port->BSRR = 1u << (pin + 16); }
+static inline void pinHigh(GPIO_TypeDef *port, int pin) { port->BSRR = 1u << pin; }
+
+static void spiWaitDone(void)
+{
+    while (!(SPI1->SR & SPI_SR_TXE)) {}
+    while (SPI1->SR & SPI_SR_BSY) {}
+}
+
+static void spiWrite8(uint8_t val)
+{
+    while (!(SPI1->SR & SPI_SR_TXE)) {}
+    *(volatile uint8_t *)&SPI1->DR = val;
+}
+
+static void lcdWriteCmd(uint8_t cmd)
+{
+    spiWaitDone();
+    pinLow(LCD_DC_PORT, LCD_DC_PIN);
+    spiWrite8(cmd);
+    spiWaitDone();
+    pinHigh(LCD_DC_PORT, LCD_DC_PIN);
+}
+
+static void lcdWriteRange(uint8_t cmd, int from, int to)
+{
+    lcdWriteCmd(cmd);
+    spiWrite8((uint8_t)(from >> 8));
+    spiWrite8((uint8_t)from);
+    spiWrite8((uint8_t)(to >> 8));
+    spiWrite8((uint8_t)to);
+}
+
+static void lcdSetRowFlip(bool flip)
+{
+    if (flip == rowFlip)
+        return;
+    lcdWriteCmd(LCD_CMD_MEMORY_ACCESS);
+    spiWrite8(flip ? (LCD_MADCTL_DEFAULT | LCD_MADCTL_ROW_FLIP) : LCD_MADCTL_DEFAULT);
+    rowFlip = flip;
+}
+
+static void dmaWaitDone(void)
+{
+    while (rowBusy) {}
+}
+
+//Ende der DMA-Übertragung: SPI leerlaufen lassen, CS freigeben, zurück auf 8 Bit
+void DMA2_Stream3_IRQHandler(void)
+{
+    if (LL_DMA_IsActiveFlag_TC3(DMA2))
+    {
+        LL_DMA_ClearFlag_TC3(DMA2);
+        LL_DMA_DisableStream(DMA2, LL_DMA_STREAM_3);
+
+        //Gleiche Zeile noch einmal: Adressfenster läuft auf der nächsten Zeile weiter
+        if (rowRepeats > 0)
+        {
+            rowRepeats--;
+            LL_DMA_SetDataLength(DMA2, LL_DMA_STREAM_3, rowWidth);
+            LL_DMA_EnableStream(DMA2, LL_DMA_STREAM_3);
+            if (rowDoneCb != NULL)
+                rowDoneCb();
+            return;
+        }
+
+        spiWaitDone();
+        SPI1->CR2 &= ~SPI_CR2_TXDMAEN;
+        SPI1->CR1 &= ~SPI_CR1_SPE;
+        SPI1->CR1 &= ~SPI_CR1_DFF;
+        SPI1->CR1 |= SPI_CR1_SPE;
+        pinHigh(LCD_CS_PORT, LCD_CS_PIN);
+
+        rowBusy = false;
+        if (rowDoneCb != NULL)
+            rowDoneCb();
+    }
+}
+#endif
 
 uint16_t rgb_to_16(RGBQUAD c)
 {
@@ -26,5 +149,106 @@ void lcd_draw_row(int x, int y, uint16_t *buf, int w)
     crd.x = x;
     crd.y = y;
 
+    lcd_wait_idle();
     GUI_WriteLine(crd, w, buf);
-}
\ No newline at end of file
+}
+
+void lcd_output_init(void)
+{
+#if LCD_ASYNC_OUTPUT
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+    LL_DMA_SetChannelSelection(DMA2, LL_DMA_STREAM_3, LL_DMA_CHANNEL_3);
+    LL_DMA_SetDataTransferDirection(DMA2, LL_DMA_STREAM_3, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetStreamPriorityLevel(DMA2, LL_DMA_STREAM_3, LL_DMA_PRIORITY_MEDIUM);
+    LL_DMA_SetMode(DMA2, LL_DMA_STREAM_3, LL_DMA_MODE_NORMAL);
+    LL_DMA_SetPeriphIncMode(DMA2, LL_DMA_STREAM_3, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(DMA2, LL_DMA_STREAM_3, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphSize(DMA2, LL_DMA_STREAM_3, LL_DMA_PDATAALIGN_HALFWORD);
+    LL_DMA_SetMemorySize(DMA2, LL_DMA_STREAM_3, LL_DMA_MDATAALIGN_HALFWORD);
+    LL_DMA_DisableFifoMode(DMA2, LL_DMA_STREAM_3);
+    LL_DMA_SetPeriphAddress(DMA2, LL_DMA_STREAM_3, (uint32_t)(uintptr_t)&SPI1->DR);
+    LL_DMA_EnableIT_TC(DMA2, LL_DMA_STREAM_3);
+    NVIC_SetPriority(DMA2_Stream3_IRQn, 6);
+    NVIC_EnableIRQ(DMA2_Stream3_IRQn);
+#endif
+}
+
+void lcd_draw_row_async(int x, int y, const uint16_t *buf, int w)
+{
+    lcd_draw_rows_async(x, y, 1, buf, w);
+}
+
+void lcd_draw_rows_async(int x, int y, int rows, const uint16_t *buf, int w)
+{
+#if LCD_ASYNC_OUTPUT
+    dmaWaitDone();
+    if (w <= 0 || rows <= 0)
+        return;
+
+    pinLow(LCD_CS_PORT, LCD_CS_PIN);
+    if (rows == 1 && y == nextRowY && x == colX && w == colW) {
+        //Nächste Zeile darüber: das Fenster läuft einfach weiter
+        lcdWriteCmd(LCD_CMD_MEMORY_CONT);
+    } else {
+        //Einzelne Zeile → Fenster von ihr bis zum oberen Rand, von unten nach oben beschrieben
+        lcdSetRowFlip(rows == 1);
+        //Bildzeilen haben alle denselben Spaltenbereich, MY ändert ihn nicht
+        if (x != colX || w != colW) {
+            lcdWriteRange(LCD_CMD_COLUMN_ADDR, x, x + w - 1);
+            colX = x;
+            colW = w;
+        }
+        if (rowFlip)
+            lcdWriteRange(LCD_CMD_PAGE_ADDR, LCD_HEIGHT - 1 - y, LCD_HEIGHT - 1);
+        else
+            lcdWriteRange(LCD_CMD_PAGE_ADDR, y, y + rows - 1);
+        lcdWriteCmd(LCD_CMD_MEMORY_WRITE);
+    }
+    nextRowY = rowFlip ? y - 1 : -1;
+
+    //Pixel als 16-Bit-Frames → RGB565 geht ohne Byte-Tausch MSB zuerst raus
+    spiWaitDone();
+    SPI1->CR1 &= ~SPI_CR1_SPE;
+    SPI1->CR1 |= SPI_CR1_DFF;
+    SPI1->CR1 |= SPI_CR1_SPE;
+
+    rowBusy = true;
+    rowRepeats = rows - 1;
+    rowWidth = (uint32_t)w;
+    LL_DMA_SetMemoryAddress(DMA2, LL_DMA_STREAM_3, (uint32_t)(uintptr_t)buf);
+    LL_DMA_SetDataLength(DMA2, LL_DMA_STREAM_3, rowWidth);
+    LL_DMA_EnableStream(DMA2, LL_DMA_STREAM_3);
+    SPI1->CR2 |= SPI_CR2_TXDMAEN;
+#else
+    for (int r = 0; r < rows; r++)
+    {
+        Coordinate crd;
+        crd.x = x;
+        crd.y = y + r;
+        GUI_WriteLine(crd, w, (uint16_t *)buf);
+        if (rowDoneCb != NULL)
+            rowDoneCb();
+    }
+#endif
+}
+
+void lcd_wait_idle(void)
+{
+#if LCD_ASYNC_OUTPUT
+    dmaWaitDone();
+    if (rowFlip) {
+        //GUI_* rechnet mit der normalen Seitenadress-Reihenfolge
+        pinLow(LCD_CS_PORT, LCD_CS_PIN);
+        lcdSetRowFlip(false);
+        spiWaitDone();
+        pinHigh(LCD_CS_PORT, LCD_CS_PIN);
+    }
+    colX = -1; //danach darf GUI_* zeichnen und setzt eigene Adressfenster
+    nextRowY = -1;
+#endif
+}
+
+void lcd_set_row_done_callback(LcdRowDoneCallback cb)
+{
+    rowDoneCb = cb;
+}
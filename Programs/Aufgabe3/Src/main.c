@@ -14,174 +14,246 @@
 #include "headers.h"
 #include "bmp_reader.h"
 #include "lcd_output.h"
-#include "scaler.h"
+#include "frame_cache.h"
+#include "render.h"
+#include "pan_zoom.h"
+#include "contact_sheet.h"
+#include "pipe_stats.h"
 #include "gpio.h"
 #include "errorhandler.h"
+#include "timer.h"
  
 //Hardware Konfiguration
 #define S0_PORT GPIOF
 #define S0_PIN  0
  
 //Display & Speicher Konfiguration
-#define LCD_WIDTH  480
-#define LCD_HEIGHT 320
-#define MAX_BMP_WIDTH 2400 //Maximal erlaubte BMP-Breite für unser System
-#define RING_BUFFER_SIZE 6 //Anzahl der Zeilen im Ring-Puffer (Teil C)
- 
-//Statische Puffer (um Stack-Overflow zu vermeiden)
-// Diese Variablen liegen im BSS-Segment (RAM), deswegen kein Stack-overflow möglich
-static uint8_t rowBuffer[RING_BUFFER_SIZE][MAX_BMP_WIDTH]; //rowBuffer[r][x] = r-te Quellzeile, bis zu 2400 Pixel breit
-static uint8_t *scalerRows[RING_BUFFER_SIZE]; //Pointer für die Zeilen, die an den Scaler übergeben werden
-static uint16_t outputLine[LCD_WIDTH];  //Ausgabezeile für LCD_WriteLine()
+#define UPSCALE_SMALL_IMAGES 1 //Kleine Bilder auf Displaygröße hochskalieren (0 = Originalgröße, zentriert)
+#define SLIDESHOW 0 //1 = Diashow ohne Taster: jedes Bild SLIDESHOW_DWELL_MS zeigen, dabei die nächste Datei vorladen
+#define SLIDESHOW_DWELL_MS 3000 //Verweilzeit pro Bild, Taste S0 schaltet sofort weiter
+#define PAN_ZOOM 0 //1 = nach dem Bild Ausschnitt per Touch: Wischen verschiebt, Tippen zoomt (Gesamtbild → 1:1 → 2:1)
+#define TAP_RADIUS 8 //Bewegung bis hier (Pixel) gilt als Tippen, weiter als Wischen
+#define TOUCH_RELEASE_MS 60 //So lange nicht berührt → Finger gilt als abgehoben (Messungen setzen kurz aus)
+#define CONTACT_SHEET 0 //1 = vor jedem Bild Vorschaubilder der Dateien: S0 blättert, Tippen wählt das Bild
+
+#if PAN_ZOOM && SLIDESHOW
+#error "PAN_ZOOM wartet auf den Taster, nicht zusammen mit SLIDESHOW"
+#endif
+#if CONTACT_SHEET && SLIDESHOW
+#error "CONTACT_SHEET wartet auf Taster oder Touch, nicht zusammen mit SLIDESHOW"
+#endif
  
 //Taster-Hilfsfunktion
 int button_pressed() {
     return readGPIOPin(S0_PORT, S0_PIN) == 0; //Taste S0 liegt auf Port F Pin 0
 }
- 
+
+//Bild stehen lassen bis zum nächsten: Taster, in der Diashow die Verweilzeit.
+//Währenddessen laufen die ersten Bursts der nächsten Datei in den Vorladepuffer (input.c),
+//das nächste Bild beginnt dann aus dem RAM statt auf den UART zu warten.
+static void wait_next_image(void) {
+#if SLIDESHOW
+    prefetchNextFile();
+    uint32_t start = getTimeStamp();
+    while (getTimeStamp() - start < SLIDESHOW_DWELL_MS * 1000u * TICKS_PER_US) {
+        prefetchPoll();
+        if (button_pressed()) {
+            while (button_pressed())
+                prefetchPoll();
+            break;
+        }
+    }
+#else
+    while (!button_pressed());
+    while (button_pressed());
+#endif
+}
+
+#if PAN_ZOOM
+//Ausschnitt-Ansicht nach dem Gesamtbild, bis Taste S0 gedrückt wird. Die Zeilen kommen per Sprung
+//in die Datei (pan_zoom.c), das Gesamtbild kommt beim Zurückzoomen aus dem Bild-Cache.
+//img: Größe und Lage des Gesamtbildes sowie sein Cache-Schlüssel aus render_image
+static void view_image(const RenderResult *img) {
+    int zoom = 0; //0 = Gesamtbild
+    int viewX = 0, viewY = 0;
+    bool touching = false;
+    uint32_t releaseStart = 0;
+    Coordinate down = {0, 0};
+    Coordinate last = {0, 0};
+
+    pan_zoom_begin(img->srcW, img->srcH, img->isRgb24);
+    while (!button_pressed()) {
+        if (TP_pressed()) {
+            Coordinate c = TP_get();
+            if (c.x < LCD_WIDTH && c.y < LCD_HEIGHT) { //ungültige Messung verwerfen
+                if (!touching)
+                    down = c;
+                last = c;
+                touching = true;
+            }
+            releaseStart = getTimeStamp();
+            continue;
+        }
+        if (!touching || getTimeStamp() - releaseStart < TOUCH_RELEASE_MS * 1000u * TICKS_PER_US)
+            continue;
+        touching = false;
+
+        int dx = last.x - down.x;
+        int dy = last.y - down.y;
+        if (abs(dx) <= TAP_RADIUS && abs(dy) <= TAP_RADIUS) {
+            //Tippen: nächste Zoomstufe, der angetippte Quellpunkt bleibt unter dem Finger
+            int srcX, srcY;
+            if (zoom == 0) {
+                srcX = (img->displayW > 0) ? (last.x - img->offsetX) * img->srcW / img->displayW : 0;
+                srcY = (img->displayH > 0) ? (last.y - img->offsetY) * img->srcH / img->displayH : 0;
+            } else {
+                srcX = viewX + last.x / zoom;
+                srcY = viewY + last.y / zoom;
+            }
+            if (zoom == PAN_ZOOM_MAX && img->cacheKeyKnown) {
+                lcd_wait_idle();
+                GUI_clear(BLACK);
+                if (frame_cache_show(img->cacheKey)) {
+                    zoom = 0;
+                    continue;
+                }
+            }
+            zoom = (zoom == 1) ? PAN_ZOOM_MAX : 1; //ohne Cache-Eintrag von 2:1 zurück auf 1:1
+            viewX = srcX - last.x / zoom;
+            viewY = srcY - last.y / zoom;
+        } else if (zoom > 0) {
+            //Wischen: Bild folgt dem Finger
+            viewX -= dx / zoom;
+            viewY -= dy / zoom;
+        } else {
+            continue;
+        }
+
+        if (pan_zoom_draw(&viewX, &viewY, zoom) != EOK) {
+            lcdErrorMsg("Ausschnitt nicht lesbar");
+            zoom = 0;
+        }
+    }
+    while (button_pressed());
+}
+#endif
+
+#if CONTACT_SHEET
+//Kontaktabzug vor jedem Bild (contact_sheet.c): Taste S0 zeigt die nächste Seite, Tippen auf ein
+//Vorschaubild wählt die Datei für das folgende openNextFile. Kann der Sender keine Dateien
+//auswählen, wird wie ohne Kontaktabzug auf den Taster gewartet.
+static void choose_file(void) {
+    static int first = 0; //erste Datei der aktuellen Seite
+    while (1) {
+        int cells = contact_sheet_show(first);
+        if (cells <= 0) {
+            while (!button_pressed());
+            while (button_pressed());
+            return;
+        }
+
+        bool touching = false;
+        uint32_t releaseStart = 0;
+        Coordinate last = {0, 0};
+        while (1) {
+            if (button_pressed()) {
+                while (button_pressed());
+                first += SHEET_CELLS;
+                if (first >= getFileCount())
+                    first = 0;
+                break;
+            }
+            if (TP_pressed()) {
+                Coordinate c = TP_get();
+                if (c.x < LCD_WIDTH && c.y < LCD_HEIGHT) { //ungültige Messung verwerfen
+                    last = c;
+                    touching = true;
+                }
+                releaseStart = getTimeStamp();
+                continue;
+            }
+            if (!touching || getTimeStamp() - releaseStart < TOUCH_RELEASE_MS * 1000u * TICKS_PER_US)
+                continue;
+            touching = false;
+
+            int cell = contact_sheet_cell(last.x, last.y);
+            if (cell >= 0 && cell < cells) {
+                selectFile(first + cell);
+                return;
+            }
+        }
+    }
+}
+#endif
+
 int main(void) //hauptprogramm
 {
     // Hardware Initialisierung
     initITSboard();
     GUI_init(DEFAULT_BRIGHTNESS);
+    initTimer();
     TP_Init(false);
  
     if (!checkVersionFlashFonts()) {
         LOOP_ON_ERR(true, "Font Mismatch");
     }
  
+#if PAN_ZOOM
+    setPanelFit(false); //Zoom braucht die volle Auflösung, der Sender darf nicht verkleinern
+#endif
     initInput();
+    lcd_output_init();
     GUI_clear(BLACK);
+
+    RenderConfig renderConfig = {
+        .upscale    = UPSCALE_SMALL_IMAGES,
+        .useCache   = true,
+        .readToEnd  = PAN_ZOOM,  //die Ausschnitt-Ansicht braucht den Zeilenindex aller RLE-Zeilen
+        .coarsePass = true,      //unkomprimiert: erst jede 8. Zeile über das ganze Bild (render.h)
+#if PIPE_STATS
+        .stage      = pipe_stats_switch,
+#else
+        .stage      = NULL,
+#endif
+    };
  
     while (1)
     {
+#if CONTACT_SHEET
+        choose_file();
+#elif !SLIDESHOW
         //Warten auf Nutzer, Button muss gedrückt und wieder losgelassen werden
         while (!button_pressed()); 
         while (button_pressed());  
+#endif
        
+#if PIPE_STATS
+        pipe_stats_begin();
+#endif
         openNextFile(); //Neues File im Python-Programm anfordern
         GUI_clear(BLACK);
+
+        //Lesen → skalieren → anzeigen (render.c), danach ist die Übertragung beendet
+        RenderResult image;
+        int status = render_image(&renderConfig, &image);
+#if PIPE_STATS
+        if (image.displayH > 0)
+            pipe_stats_report(image.displayH);
+#endif
  
-        //Variablen für Header anlegen
-        BITMAPFILEHEADER fh;
-        BITMAPINFOHEADER ih;
-       
-        // ÄNDERUNG: Statisches Array statt malloc.
-        // Belegt festen Speicher (1KB) und verhindert Fragmentierung/Lecks.
-        static RGBQUAD pal[256];
- 
-        // 3. Header einlesen
-        // bmp_start füllt nun das statische Array 'pal'
-        if (bmp_start(&fh, &ih, pal) != EOK) {
-            // Kein free(pal) mehr nötig!
-           
-            //Warten, damit Fehlermeldung gelesen werden kann
-            while (!button_pressed());
-            while (button_pressed());
-            continue;
-        }
- 
-        int srcW = ih.biWidth;
-        int srcH = ih.biHeight;
- 
-        //Sicherheitsprüfung: Bild darf nicht breiter sein, als das RAM erlaubt
-        if (srcW > MAX_BMP_WIDTH) {
-            lcdErrorMsg("Bild zu breit!");
-            
-            while (!button_pressed());
-            while (button_pressed());
+#if PAN_ZOOM
+        //Ausschnitt per Touch, nur wenn der Sender in die Datei springen kann
+        InputStats inputStats;
+        getInputStats(&inputStats);
+        if (status == EOK && inputStats.seekMode) {
+            view_image(&image);
             continue;
         }
- 
-        
-        //SKALIERUNGS-BERECHNUNG (Fit-to-Screen)
-        float scale_x = (float)LCD_WIDTH / (float)srcW;
-        float scale_y = (float)LCD_HEIGHT / (float)srcH;
- 
-        //Kleineren Faktor wählen → Bild vollständig sichtbar
-        float scale = (scale_x < scale_y) ? scale_x : scale_y;
- 
-        // Kein Upscaling (das ist hier optional)
-        if (scale > 1.0f) scale = 1.0f;
- 
-        //Größe des angezeigten Bildes
-        int displayImageWidth  = (int)(srcW * scale);
-        int displayImageHeight = (int)(srcH * scale);
- 
-        //Zentrierung durch Letterboxing
-        int offsetX = (LCD_WIDTH - displayImageWidth) / 2;
-        int offsetY = (LCD_HEIGHT - displayImageHeight) / 2;
- 
-        //Box-Größe (Wie viele Quellzeilen pro Zielzeile?)
-        int boxSize = (int)ceilf(1.0f / scale);
-        if (boxSize > RING_BUFFER_SIZE) boxSize = RING_BUFFER_SIZE;
-        if (boxSize < 1) boxSize = 1;
- 
+#else
+        (void)status;
+#endif
 
-        //STREAMING LOOP (Teilaufgabe C) / Zeilenweise lesen → skalieren → anzeigen
-        int rowsReadTotal = 0;
-        int bmpStatus = 0; // 0 = OK, -1 = Fehler/EOF
- 
-        // Iteration über die HÖHE des Zielbildes
-        for (int i = 0; i < displayImageHeight; i++)
-        {
-            //Welche Zeilen brauchen wir aus dem Quellbild?
-            float srcY_start_f = (float)i / scale;
-           
-            int startSrcRow = (int)floorf(srcY_start_f);
-            int endSrcRow   = startSrcRow + boxSize;
- 
-            if (endSrcRow > srcH) endSrcRow = srcH;
- 
-            //B. Ringpuffer nachladen
-            //Solange lesen, bis wir genug Zeilen für die Box-Berechnung haben
-            while (rowsReadTotal < endSrcRow && bmpStatus == 0)
-            {
-                uint8_t *bufPtr = rowBuffer[rowsReadTotal % RING_BUFFER_SIZE];
-               
-                //Zeile einlesen (ruft RLE oder RAW Logik auf)
-                int res = bmp_read_row(bufPtr, srcW);
-                if (res != 0) {
-                    bmpStatus = -1; // Abbruch markieren
-                }
-                rowsReadTotal++;
-            }
- 
-            //Zeiger für den Scaler vorbereiten
-            int validRows = 0;
-            for (int r = startSrcRow; r < endSrcRow; r++)
-            {
-                // Nur Zeilen nutzen, die wir erfolgreich gelesen haben
-                if (r < rowsReadTotal) {
-                    scalerRows[validRows] = rowBuffer[r % RING_BUFFER_SIZE];
-                    validRows++;
-                }
-            }
- 
-            //Skalierung + Ausgabe der fertigen LCD-Zeile
-            if (validRows > 0)
-            {
-                // Aufruf der Skalierungsfunktion
-                scale_line_box_fit(outputLine, scalerRows, validRows,
-                                   srcW, scale, offsetX, displayImageWidth, pal);
-               
-                // Y-Position berechnen (BMP ist Bottom-Up!)
-                // Wir zeichnen von unten nach oben auf das Display
-                int lcdY = (offsetY + displayImageHeight - 1) - i;
-               
-                // Zeichnen (Ganze Zeile wird geschrieben)
-                lcd_draw_row(0, lcdY, outputLine, LCD_WIDTH);
-            }
-        }
- 
-        //Restliche Zeilen auslesen (damit UART Puffer leer ist für nächstes Bild)
-        while (rowsReadTotal < srcH && bmpStatus == 0) {
-            bmp_read_row(rowBuffer[0], srcW);
-            rowsReadTotal++;
-        }
- 
-        // Warten auf User Eingabe für das nächste Bild
-        while (!button_pressed());
-        while (button_pressed());
+        // Warten auf User Eingabe (Diashow: Verweilzeit) für das nächste Bild
+        wait_next_image();
     }
 }
\ No newline at end of file
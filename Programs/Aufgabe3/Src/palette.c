@@ -1,15 +1,44 @@
 #include "palette.h"
 #include "input.h"
+#include "lcd_output.h"
 #include "errorhandler.h"
 
+uint32_t palPacked[MAX_COLOR_TABLE_SIZE];
+uint16_t pal565[MAX_COLOR_TABLE_SIZE];
+uint32_t pal888[MAX_COLOR_TABLE_SIZE];
+
 int load_palette(RGBQUAD *pal, int count)
 {
-    for(int i = 0; i < count; i++)
+    //RGBQUAD entspricht genau dem Dateiformat → ganze Palette in einem Block lesen
+    if (count > 0 && count != COMread((char*)pal, sizeof(RGBQUAD), (unsigned int)count)) //Datenstrom abgebrochen → Fehler
+        return NOK;
+    return EOK;
+}
+
+void palette_build_luts(const RGBQUAD *pal, int count)
+{
+    if (count > MAX_COLOR_TABLE_SIZE) count = MAX_COLOR_TABLE_SIZE;
+
+    for (int i = 0; i < MAX_COLOR_TABLE_SIZE; i++)
     {
-        if (1 != COMread((char*)&pal[i], sizeof(RGBQUAD), 1)) //Wenn COMread < 1 zurückgibt → Datenstrom abgebrochen → Fehler
-            return NOK;
+        if (i < count)
+        {
+            palPacked[i] = ((uint32_t)(pal[i].rgbRed   >> 2) << PAL_PACK_SHIFT_R)
+                         | ((uint32_t)(pal[i].rgbGreen >> 2) << PAL_PACK_SHIFT_G)
+                         |  (uint32_t)(pal[i].rgbBlue  >> 2);
+            pal565[i]    = rgb_to_16(pal[i]);
+            pal888[i]    = ((uint32_t)pal[i].rgbRed << 16)
+                         | ((uint32_t)pal[i].rgbGreen << 8)
+                         |  (uint32_t)pal[i].rgbBlue;
+        }
+        else
+        {
+            //Index außerhalb von biClrUsed → Schwarz
+            palPacked[i] = 0;
+            pal565[i]    = 0;
+            pal888[i]    = 0;
+        }
     }
-    return EOK;
 }
 
 
@@ -17,4 +46,4 @@ int load_palette(RGBQUAD *pal, int count)
 //             Byte 0 = Blue
 //             Byte 1 = Green
 //             Byte 2 = Red
-//             Byte 3 = Reserved
\ No newline at end of file
+//             Byte 3 = Reserved
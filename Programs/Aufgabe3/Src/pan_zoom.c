@@ -0,0 +1,127 @@
+#include "pan_zoom.h"
+#include "bmp_reader.h"
+#include "input.h"
+#include "lcd_output.h"
+#include "palette.h"
+#include "errorhandler.h"
+#include "LCD_GUI.h"
+
+static int imgW = 0;
+static int imgH = 0;
+static bool imgRgb24 = false;
+
+//Ausschnitt der gerade dekodierten Zeile: Quellspalten [viewX, viewX + viewW), jede zoom-mal
+static int viewX = 0;
+static int viewW = 0;
+static int zoom = 1;
+
+//Doppelpuffer wie in render.c: eine Zeile wird gesendet, in die andere schreiben die Empfänger
+static uint16_t viewLines[2][PAN_ZOOM_LCD_WIDTH];
+static uint16_t *line = viewLines[0];
+
+//Quellspalten [x, x + n) auf den Ausschnitt begrenzen, false wenn nichts davon sichtbar ist
+static inline bool clip(int x, int n, int *x0, int *x1)
+{
+    *x0 = (x > viewX) ? x : viewX;
+    *x1 = (x + n < viewX + viewW) ? x + n : viewX + viewW;
+    return *x0 < *x1;
+}
+
+static inline void put(int sx, uint16_t c)
+{
+    uint16_t *out = &line[(sx - viewX) * zoom];
+    for (int k = 0; k < zoom; k++)
+        out[k] = c;
+}
+
+static void view_run(int x, int len, uint8_t color)
+{
+    int x0, x1;
+    if (!clip(x, len, &x0, &x1))
+        return;
+    uint16_t c = pal565[color];
+    for (int sx = x0; sx < x1; sx++)
+        put(sx, c);
+}
+
+static void view_literal(int x, const uint8_t *src, int n)
+{
+    int x0, x1;
+    if (!clip(x, n, &x0, &x1))
+        return;
+    for (int sx = x0; sx < x1; sx++)
+        put(sx, pal565[src[sx - x]]);
+}
+
+static void view_rgb24(int x, const uint8_t *bgr, int n)
+{
+    int x0, x1;
+    if (!clip(x, n, &x0, &x1))
+        return;
+    for (int sx = x0; sx < x1; sx++)
+    {
+        const uint8_t *p = &bgr[(sx - x) * 3];
+        put(sx, (uint16_t)(((p[2] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[0] >> 3)));
+    }
+}
+
+static const SpanSink viewSink = { view_run, view_literal };
+
+void pan_zoom_begin(int srcW, int srcH, bool isRgb24)
+{
+    imgW = srcW;
+    imgH = srcH;
+    imgRgb24 = isRgb24;
+}
+
+int pan_zoom_draw(int *x, int *y, int z)
+{
+    int w = PAN_ZOOM_LCD_WIDTH / z;
+    int h = PAN_ZOOM_LCD_HEIGHT / z;
+    if (w > imgW) w = imgW;
+    if (h > imgH) h = imgH;
+
+    //Ecke begrenzen → Ausschnitt liegt ganz im Bild
+    if (*x > imgW - w) *x = imgW - w;
+    if (*y > imgH - h) *y = imgH - h;
+    if (*x < 0) *x = 0;
+    if (*y < 0) *y = 0;
+
+    //BMP ist Bottom-Up: oberste LCD-Zeile des Ausschnitts ist Quellzeile rowTop
+    int rowTop = imgH - 1 - *y;
+    int rowBottom = rowTop - h + 1;
+    if (bmp_seek_rows(rowBottom, rowTop) != EOK)
+        return NOK;
+
+    viewX = *x;
+    viewW = w;
+    zoom = z;
+    int offsetX = (PAN_ZOOM_LCD_WIDTH - w * z) / 2;
+    int offsetY = (PAN_ZOOM_LCD_HEIGHT - h * z) / 2;
+
+    lcd_wait_idle();
+    if (offsetX > 0 || offsetY > 0)
+        GUI_clear(BLACK);
+
+    int idx = 0;
+    for (int r = rowBottom; r <= rowTop; r++)
+    {
+        line = viewLines[idx];
+        int res = imgRgb24 ? bmp_stream_row_rgb24(imgW, view_rgb24) : bmp_stream_row_spans(&viewSink);
+        if (res != 0) {
+            lcd_wait_idle();
+            return NOK;
+        }
+        lcd_draw_rows_async(offsetX, offsetY + (rowTop - r) * z, z, line, w * z);
+        idx ^= 1;
+    }
+
+    //Rest des Bereichs (höchstens bis zum nächsten Indexeintrag) lesen → keine Bursts mehr unterwegs
+    const char *data;
+    int n;
+    while ((n = nextSpan(&data)) > 0)
+        consumeSpan(n);
+
+    lcd_wait_idle();
+    return EOK;
+}
@@ -0,0 +1,72 @@
+#include "pipe_stats.h"
+
+#if PIPE_STATS
+#include "stm32f4xx.h"
+#include "input.h"
+#include "lcd_output.h"
+#include "LCD_GUI.h"
+#include "fontsFLASH.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint64_t cycles[PIPE_STAGES]; //CYCCNT läuft nach ~24 s über, die Summen nicht
+static PipeStage current = PIPE_OTHER;
+static uint32_t lastStamp = 0;
+static uint32_t bytesAtBegin = 0;
+
+void pipe_stats_begin(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(cycles, 0, sizeof(cycles));
+    current = PIPE_OTHER;
+    lastStamp = DWT->CYCCNT;
+
+    InputStats st;
+    getInputStats(&st);
+    bytesAtBegin = st.bytesReceived;
+}
+
+PipeStage pipe_stats_switch(PipeStage stage)
+{
+    uint32_t now = DWT->CYCCNT;
+    cycles[current] += now - lastStamp; //Differenz stimmt auch über den Überlauf hinweg
+    lastStamp = now;
+
+    PipeStage prev = current;
+    current = stage;
+    return prev;
+}
+
+void pipe_stats_report(int rows)
+{
+    pipe_stats_switch(PIPE_OTHER);
+
+    uint32_t cyclesPerMs = SystemCoreClock / 1000u;
+    uint32_t ms[PIPE_STAGES];
+    uint32_t totalMs = 0;
+    for (int s = 0; s < PIPE_STAGES; s++) {
+        ms[s] = (uint32_t)(cycles[s] / cyclesPerMs);
+        totalMs += ms[s];
+    }
+    if (totalMs == 0)
+        totalMs = 1;
+
+    InputStats st;
+    getInputStats(&st);
+    uint32_t bytes = st.bytesReceived - bytesAtBegin;
+
+    //K=Header U=UART D=Dekodieren S=Skalieren L=LCD R=Rest, passt mit Font16 in eine Zeile
+    char line[64];
+    snprintf(line, sizeof(line), "K%u U%u D%u S%u L%u R%u ms %uKB/s %uZ/s",
+             (unsigned)ms[PIPE_HEADER], (unsigned)ms[PIPE_UART], (unsigned)ms[PIPE_DECODE],
+             (unsigned)ms[PIPE_SCALE], (unsigned)ms[PIPE_LCD], (unsigned)ms[PIPE_OTHER],
+             (unsigned)((uint64_t)bytes * 1000u / 1024u / totalMs),
+             (unsigned)((uint64_t)rows * 1000u / totalMs));
+
+    Coordinate pos = {0, LCD_HEIGHT - 48};
+    GUI_disStr(pos, line, &Font16, WHITE, RED);
+    sendText(line);
+}
+#endif
@@ -0,0 +1,68 @@
+#include "pixel_unpack.h"
+#include <string.h>
+
+//Zwei Bytes eines 16-Bit-Werts auf Byte 0 und 2 eines Worts verteilen
+static inline uint32_t spread16(uint32_t v)
+{
+    return ((v << 8) | v) & 0x00FF00FFu;
+}
+
+void unpack_4bpp(uint8_t *dst, const uint8_t *src, int pixels)
+{
+    //4 Quellbytes → 8 Indizes: obere Nibbles an gerade, untere an ungerade Positionen
+    while (pixels >= 8)
+    {
+        uint32_t w;
+        memcpy(&w, src, 4); // Cortex-M4: unausgerichtetes LDR
+        uint32_t hi = (w >> 4) & 0x0F0F0F0Fu;
+        uint32_t lo = w & 0x0F0F0F0Fu;
+        uint32_t out0 = spread16(hi & 0xFFFFu) | (spread16(lo & 0xFFFFu) << 8);
+        uint32_t out1 = spread16(hi >> 16) | (spread16(lo >> 16) << 8);
+        memcpy(dst, &out0, 4);
+        memcpy(dst + 4, &out1, 4);
+        src += 4;
+        dst += 8;
+        pixels -= 8;
+    }
+
+    for (int i = 0; i < pixels; i++)
+        dst[i] = (i & 1) ? (src[i >> 1] & 0x0F) : (src[i >> 1] >> 4);
+}
+
+//Nibble (4 Pixel) → 4 Indizes 0/1 als ein Wort, Byte 0 = höchstwertiges Bit
+static const uint32_t bitLut[16] = {
+    0x00000000u, 0x01000000u, 0x00010000u, 0x01010000u,
+    0x00000100u, 0x01000100u, 0x00010100u, 0x01010100u,
+    0x00000001u, 0x01000001u, 0x00010001u, 0x01010001u,
+    0x00000101u, 0x01000101u, 0x00010101u, 0x01010101u,
+};
+
+void unpack_1bpp(uint8_t *dst, const uint8_t *src, int pixels)
+{
+    while (pixels >= 8)
+    {
+        uint8_t b = *src++;
+        memcpy(dst, &bitLut[b >> 4], 4);
+        memcpy(dst + 4, &bitLut[b & 0x0F], 4);
+        dst += 8;
+        pixels -= 8;
+    }
+
+    for (int i = 0; i < pixels; i++)
+        dst[i] = (uint8_t)((*src >> (7 - i)) & 1);
+}
+
+void unpack_pair(uint8_t *dst, uint8_t first, uint8_t second, int pixels)
+{
+    uint32_t pattern = first | ((uint32_t)second << 8);
+    pattern |= pattern << 16;
+
+    while (pixels >= 4)
+    {
+        memcpy(dst, &pattern, 4);
+        dst += 4;
+        pixels -= 4;
+    }
+    for (int i = 0; i < pixels; i++)
+        dst[i] = (i & 1) ? second : first;
+}
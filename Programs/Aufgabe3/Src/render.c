@@ -0,0 +1,526 @@
+#include "render.h"
+#include "bmp_reader.h"
+#include "headers.h"
+#include "scaler.h"
+#include "input.h"
+#include "lcd_output.h"
+#include "frame_cache.h"
+#include "errorhandler.h"
+#include "LCD_GUI.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#if SCALER_BENCH || SCALER_COMPARE_FLOAT
+#include <stdio.h>
+#include "fontsFLASH.h"
+#include "timer.h"
+#endif
+
+//Statische Puffer (um Stack-Overflow zu vermeiden)
+// Diese Variablen liegen im BSS-Segment (RAM), deswegen kein Stack-overflow möglich
+static uint8_t rowBuffer[RING_BUFFER_SIZE][MAX_BMP_WIDTH]; //Literal-Speicher der Span-Zeilen (nur kurze Läufe / Absolute Mode)
+static SpanRow spanRing[RING_BUFFER_SIZE]; //spanRing[r] = r-te Quellzeile als Läufe
+static SpanRow *scalerRows[RING_BUFFER_SIZE]; //Pointer für die Zeilen, die an den Scaler übergeben werden
+static uint8_t *rgbRows[RING_BUFFER_SIZE]; //24 Bit: Zeilen liegen direkt in rowBuffer (3 Byte pro Pixel)
+#if SCALER_COMPARE_FLOAT
+static uint8_t *compareRows[RING_BUFFER_SIZE]; //Ausgeschriebene Pixelzeilen für den alten Float-Kernel
+static uint16_t compareLine[LCD_WIDTH]; //Ziel für den alten Float-Kernel (wird nicht angezeigt)
+#endif
+static uint16_t outputLine[2][LCD_WIDTH]; //Doppelpuffer: eine Zeile wird per DMA gesendet, die andere skaliert
+static const SpanSink streamSink = { scale_stream_run, scale_stream_literal }; //RLE8-Spans direkt in die Spalten-Akkumulatoren
+static RGBQUAD pal[256];
+static const RenderConfig *config;
+static int imageX = 0;               //Spalten des angezeigten Bildes: nur sie gehen ans LCD,
+static int imageW = LCD_WIDTH;       //die Letterbox-Balken hat GUI_clear(BLACK) schon gezeichnet
+
+#define STAGE(s) do { if (config->stage != NULL) config->stage(s); } while (0)
+
+//Fertige LCD-Zeile senden und für den Bild-Cache aufzeichnen
+static void show_row(int lcdY, uint16_t *row) {
+    if (config->useCache)
+        frame_cache_add_line(lcdY, row);
+    lcd_draw_row_async(imageX, lcdY, row + imageX, imageW);
+}
+
+#if PROGRESSIVE_PREVIEW
+//Vorschau: Zeile i (i % PREVIEW_STEP == 0) in die darüberliegenden Zeilen ihres Blocks kopieren,
+//die fertigen Zeilen überschreiben sie beim Weiterlesen (nicht im Bild-Cache)
+static void show_preview(int i, int lcdY, const uint16_t *row, int displayImageHeight) {
+    int rows = displayImageHeight - 1 - i;
+    if (i % PREVIEW_STEP != 0 || rows <= 0)
+        return;
+    if (rows > PREVIEW_STEP - 1)
+        rows = PREVIEW_STEP - 1;
+    lcd_draw_rows_async(imageX, lcdY - rows, rows, row + imageX, imageW);
+}
+#endif
+
+//Verkleinern: Box der Ausgabezeile i = Quellzeilen *startSrcRow .. *endSrcRow - 1
+static void box_rows(int i, float scale, int intFactor, int boxSize, int srcH, int *startSrcRow, int *endSrcRow) {
+    //Welche Zeilen brauchen wir aus dem Quellbild?
+    float srcY_start_f = (float)i / scale;
+
+    *startSrcRow = (intFactor > 0) ? i * intFactor : (int)floorf(srcY_start_f);
+    *endSrcRow   = *startSrcRow + boxSize;
+
+    if (*endSrcRow > srcH) *endSrcRow = srcH;
+}
+
+int render_image(const RenderConfig *cfg, RenderResult *res) {
+    BITMAPFILEHEADER fh;
+    BITMAPINFOHEADER ih;
+
+    config = cfg;
+    memset(res, 0, sizeof(*res));
+
+    //Jede Span-Zeile bekommt ihren festen Literal-Speicher
+    for (int r = 0; r < RING_BUFFER_SIZE; r++)
+        spanRing[r].literal = rowBuffer[r];
+
+    // Header einlesen, bmp_start füllt das statische Array 'pal'
+    STAGE(PIPE_HEADER);
+    if (bmp_start(&fh, &ih, pal) != EOK) {
+        stopFile(); //Rest der abgelehnten Datei nicht mehr übertragen
+        STAGE(PIPE_OTHER);
+        return NOK;
+    }
+    STAGE(PIPE_OTHER);
+
+    int srcW = ih.biWidth;
+    int srcH = ih.biHeight;
+    bool isRgb24 = (ih.biBitCount == 24); //bmp_start lässt nur Palettenbilder (RLE8, RLE4, 1/4 Bit) oder 24 Bit BI_RGB durch
+    res->srcW = srcW;
+    res->srcH = srcH;
+    res->bitCount = ih.biBitCount;
+    res->isRgb24 = isRgb24;
+
+    //Passt eine Zeile nicht in den Ringpuffer, werden die Quellzeilen gar nicht gespeichert,
+    //sondern direkt in die Spalten-Akkumulatoren gefaltet (dann immer Verkleinern, scale < 0.6)
+    //24 Bit braucht 3 Byte pro Pixel + 1 Byte, das der SIMD-Kernel hinter dem letzten Pixel liest
+    bool streamRows = (srcW > MAX_BMP_WIDTH || (isRgb24 && srcW * 3 >= MAX_BMP_WIDTH));
+    res->streamed = streamRows;
+
+    //Sicherheitsprüfung: Bild darf nicht breiter sein, als die Spaltentabelle erlaubt
+    if (srcW > MAX_STREAM_WIDTH) {
+        lcdErrorMsg("Bild zu breit!");
+        stopFile();
+        return NOK;
+    }
+
+    //SKALIERUNGS-BERECHNUNG (Fit-to-Screen)
+    float scale_x = (float)LCD_WIDTH / (float)srcW;
+    float scale_y = (float)LCD_HEIGHT / (float)srcH;
+
+    //Kleineren Faktor wählen → Bild vollständig sichtbar
+    float scale = (scale_x < scale_y) ? scale_x : scale_y;
+
+    // Ohne Upscaling höchstens 1:1
+    if (!cfg->upscale && scale > 1.0f) scale = 1.0f;
+
+    //Größe des angezeigten Bildes
+    int displayImageWidth  = (int)(srcW * scale);
+    int displayImageHeight = (int)(srcH * scale);
+
+    //Zentrierung durch Letterboxing
+    int offsetX = (LCD_WIDTH - displayImageWidth) / 2;
+    int offsetY = (LCD_HEIGHT - displayImageHeight) / 2;
+    res->offsetX = offsetX;
+    res->offsetY = offsetY;
+    res->displayW = displayImageWidth;
+    res->displayH = displayImageHeight;
+
+    //Box-Größe (Wie viele Quellzeilen pro Zielzeile?)
+    int boxSize = (int)ceilf(1.0f / scale);
+    if (boxSize > RING_BUFFER_SIZE) boxSize = RING_BUFFER_SIZE;
+    if (boxSize < 1) boxSize = 1;
+
+    //Spaltentabelle einmal pro Bild berechnen → Zeilen-Kernel ohne FPU
+    STAGE(PIPE_SCALE);
+    scaler_init(srcW, scale, offsetX, displayImageWidth, boxSize);
+    STAGE(PIPE_OTHER);
+    if (cfg->useCache)
+        frame_cache_begin();
+    imageX = offsetX;
+    imageW = displayImageWidth;
+
+#if SCALER_COMPARE_FLOAT
+    uint32_t ticksFixed = 0;
+    uint32_t ticksFloat = 0;
+    int scaledRows = 0;
+#endif
+#if SCALER_BENCH
+    uint32_t benchTicks = 0;
+    int benchRows = 0;
+#endif
+
+    //STREAMING LOOP (Teilaufgabe C) / Zeilenweise lesen → skalieren → anzeigen
+    int rowsReadTotal = 0;
+    int bmpStatus = 0; // 0 = OK, -1 = Fehler/EOF
+    int outIdx = 0;    // Welcher Ausgabepuffer gerade beschrieben wird
+
+    //Hochskalieren: jede Quellzeile wird nur einmal dekodiert und bleibt im Ringpuffer
+    ScalerMode mode = scaler_mode();
+    int intFactor = scaler_int_factor(); // >0: exakte Verkleinerung, Zeilen ohne Float-Rundung
+    int upShownRow = -1;        // zuletzt vervielfachte Quellzeile (SCALER_UP_INTEGER)
+    uint16_t *upRowBuf = NULL;  // deren fertige LCD-Zeile, wird mehrfach gesendet
+
+    //Bild-Cache: Schlüssel steht fest, sobald Header + erster Burst gelesen sind
+    uint32_t cacheKey = 0;
+    bool cacheKeyKnown = false;
+    bool cacheHit = false;
+
+    //Grobdurchlauf nur, wenn jede Quellzeile per Sprung erreichbar ist: unkomprimiert (Position berechenbar)
+    //und der Sender versteht SEEK_OUT_CMD. RLE und das alte Protokoll zeigen die Vorschau mitlaufend (show_preview).
+#if PROGRESSIVE_PREVIEW
+    InputStats inputStats;
+    getInputStats(&inputStats);
+    bool coarseFirst = cfg->coarsePass && inputStats.seekMode && ih.biCompression == BI_RGB
+                  && mode == SCALER_DOWN && !streamRows && displayImageHeight > PREVIEW_STEP;
+    if (coarseFirst)
+    {
+        //Schlüssel vor dem ersten Sprung: Kopf der Datei lesen, er ist mit den ersten Bursts ohnehin unterwegs
+        if (cfg->useCache) {
+            const char *head;
+            int n;
+            STAGE(PIPE_DECODE);
+            while (!getHeadHash(&cacheKey) && (n = nextSpan(&head)) > 0)
+                consumeSpan(n);
+            cacheKeyKnown = getHeadHash(&cacheKey);
+            STAGE(PIPE_LCD);
+            if (cacheKeyKnown && frame_cache_show(cacheKey)) {
+                cacheHit = true;
+                res->outRows = displayImageHeight;
+            }
+        }
+
+        //Jede PREVIEW_STEP-te Ausgabezeile: nur ihre Box anfordern, skalieren und über den Block vervielfachen.
+        //Nicht im Bild-Cache, der Feindurchlauf zeichnet auch diese Zeilen neu.
+        for (int i = 0; i < displayImageHeight && !cacheHit && bmpStatus == 0; i += PREVIEW_STEP)
+        {
+            int startSrcRow, endSrcRow;
+            box_rows(i, scale, intFactor, boxSize, srcH, &startSrcRow, &endSrcRow);
+
+            STAGE(PIPE_DECODE);
+            if (bmp_seek_rows(startSrcRow, endSrcRow - 1) != EOK)
+                bmpStatus = -1;
+            int validRows = 0;
+            for (int r = startSrcRow; r < endSrcRow && bmpStatus == 0; r++)
+            {
+                int rc = isRgb24 ? bmp_read_row_rgb24(rowBuffer[validRows], srcW)
+                                 : bmp_read_row_spans(&spanRing[validRows], srcW);
+                if (rc != 0) {
+                    bmpStatus = -1;
+                } else {
+                    scalerRows[validRows] = &spanRing[validRows];
+                    rgbRows[validRows]    = rowBuffer[validRows];
+                    validRows++;
+                }
+            }
+            if (bmpStatus != 0)
+                break;
+
+            uint16_t *outputRow = outputLine[outIdx];
+            STAGE(PIPE_SCALE);
+            if (isRgb24)
+                scale_rgb24_box_fit(outputRow, rgbRows, validRows);
+            else
+                scale_spans_box_fit(outputRow, scalerRows, validRows);
+
+            //Block von Ausgabezeile i bis i + PREVIEW_STEP - 1, auf dem LCD von lcdY nach oben
+            int rows = displayImageHeight - i;
+            if (rows > PREVIEW_STEP)
+                rows = PREVIEW_STEP;
+            int lcdY = (offsetY + displayImageHeight - 1) - i;
+            STAGE(PIPE_LCD);
+            lcd_draw_rows_async(imageX, lcdY - rows + 1, rows, outputRow + imageX, imageW);
+            outIdx ^= 1;
+        }
+
+        //Feindurchlauf: alle Zeilen in einem Bereich, dieselbe Schleife wie ohne Sprung
+        STAGE(PIPE_DECODE);
+        if (!cacheHit && bmpStatus == 0 && bmp_seek_rows(0, srcH - 1) != EOK)
+            bmpStatus = -1;
+    }
+#endif
+
+    // Iteration über die HÖHE des Zielbildes
+    for (int i = 0; i < displayImageHeight && !cacheHit; i++)
+    {
+        if (cfg->useCache && !cacheKeyKnown && getHeadHash(&cacheKey)) {
+            cacheKeyKnown = true;
+            STAGE(PIPE_LCD);
+            if (frame_cache_show(cacheKey)) {
+                cacheHit = true; //Bild schon bekannt → aus dem Cache gezeichnet, Rest wird nicht mehr gebraucht
+                res->outRows = displayImageHeight;
+                break;
+            }
+        }
+
+        int startSrcRow, endSrcRow;
+        int upY0 = 0, upY1 = 0;
+        uint32_t upFy = 0;
+
+        if (mode == SCALER_DOWN)
+        {
+            box_rows(i, scale, intFactor, boxSize, srcH, &startSrcRow, &endSrcRow);
+        }
+        else
+        {
+            //Eine (ganzzahlig) oder zwei (bilinear) Quellzeilen pro Ausgabezeile
+            scaler_up_rows(i, srcH, &upY0, &upY1, &upFy);
+            startSrcRow = upY0;
+            endSrcRow   = upY1 + 1;
+        }
+
+        int lcdY = (offsetY + displayImageHeight - 1) - i; // BMP ist Bottom-Up
+
+        if (streamRows)
+        {
+            //Box endet bei der ersten Quellzeile der nächsten Ausgabezeile → keine Zeile wird zweimal gebraucht
+            int streamEnd = (intFactor > 0) ? startSrcRow + intFactor : (int)floorf((float)(i + 1) / scale);
+            if (streamEnd <= startSrcRow) streamEnd = startSrcRow + 1;
+            if (streamEnd > srcH) streamEnd = srcH;
+
+            STAGE(PIPE_DECODE); //Dekodieren und Falten in die Akkumulatoren sind verschränkt
+            scale_stream_begin();
+            int streamed = 0;
+            while (rowsReadTotal < streamEnd && bmpStatus == 0)
+            {
+                int rc;
+                if (rowsReadTotal < startSrcRow) {
+                    rc = bmp_skip_row(srcW);
+                } else {
+                    rc = isRgb24 ? bmp_stream_row_rgb24(srcW, scale_stream_rgb24)
+                                 : bmp_stream_row_spans(&streamSink);
+                    streamed++;
+                }
+                if (rc != 0)
+                    bmpStatus = -1;
+                rowsReadTotal++;
+            }
+
+            if (streamed > 0 && bmpStatus == 0)
+            {
+                uint16_t *outputRow = outputLine[outIdx];
+                STAGE(PIPE_SCALE);
+                if (isRgb24)
+                    scale_stream_finish_rgb24(outputRow, streamed);
+                else
+                    scale_stream_finish_spans(outputRow, streamed);
+
+                STAGE(PIPE_LCD);
+                show_row(lcdY, outputRow);
+#if PROGRESSIVE_PREVIEW
+                show_preview(i, lcdY, outputRow, displayImageHeight);
+#endif
+                outIdx ^= 1;
+                res->outRows++;
+            }
+            continue;
+        }
+
+        //B. Ringpuffer nachladen
+        //Solange lesen, bis wir genug Zeilen für die Box-Berechnung haben
+        STAGE(PIPE_DECODE);
+        while (rowsReadTotal < endSrcRow && bmpStatus == 0)
+        {
+            int slot = rowsReadTotal % RING_BUFFER_SIZE;
+            bool sampled = (rowsReadTotal >= startSrcRow);
+            int rc;
+
+            if (!sampled) {
+                //Zeile liegt vor der Box (Box bei kleinen Faktoren auf RING_BUFFER_SIZE begrenzt) → nur überlesen
+                rc = bmp_skip_row(srcW);
+            } else if (isRgb24) {
+                //24 Bit: Pixel direkt in den Zeilenpuffer
+                rc = bmp_read_row_rgb24(rowBuffer[slot], srcW);
+            } else {
+                //Zeile als Läufe einlesen (ruft RLE oder RAW Logik auf)
+                rc = bmp_read_row_spans(&spanRing[slot], srcW);
+            }
+            if (rc != 0) {
+                bmpStatus = -1; // Abbruch markieren
+            } else if (sampled && mode == SCALER_UP_BILINEAR) {
+                //Horizontal nur einmal pro Quellzeile interpolieren
+                STAGE(PIPE_SCALE);
+                if (isRgb24)
+                    scale_up_prepare_rgb24(rowBuffer[slot], rowsReadTotal);
+                else
+                    scale_up_prepare_spans(&spanRing[slot], rowsReadTotal);
+                STAGE(PIPE_DECODE);
+            }
+            rowsReadTotal++;
+        }
+
+        if (mode != SCALER_DOWN)
+        {
+            if (endSrcRow > rowsReadTotal || bmpStatus != 0)
+                continue; // Quellzeile fehlt (Lesefehler) → nichts zeichnen
+
+            STAGE(PIPE_SCALE);
+#if SCALER_BENCH
+            uint32_t tBench = getTimeStamp();
+#endif
+            if (mode == SCALER_UP_INTEGER)
+            {
+                //Quellzeile einmal vervielfachen, danach denselben Puffer für alle Wiederholungen senden
+                if (upY0 != upShownRow)
+                {
+                    int slot = upY0 % RING_BUFFER_SIZE;
+                    upRowBuf = outputLine[outIdx];
+                    outIdx ^= 1;
+                    if (isRgb24)
+                        scale_up_replicate_rgb24(upRowBuf, rowBuffer[slot]);
+                    else
+                        scale_up_replicate_spans(upRowBuf, &spanRing[slot]);
+                    upShownRow = upY0;
+                }
+            }
+            else
+            {
+                upRowBuf = outputLine[outIdx];
+                outIdx ^= 1;
+                scale_up_blend(upRowBuf, upY0, upY1, upFy);
+            }
+#if SCALER_BENCH
+            benchTicks += getTimeStamp() - tBench;
+            benchRows++;
+#endif
+            STAGE(PIPE_LCD);
+            show_row(lcdY, upRowBuf);
+            res->outRows++;
+            continue;
+        }
+
+        //Zeiger für den Scaler vorbereiten
+        int validRows = 0;
+        for (int r = startSrcRow; r < endSrcRow; r++)
+        {
+            // Nur Zeilen nutzen, die wir erfolgreich gelesen haben
+            if (r < rowsReadTotal) {
+                scalerRows[validRows] = &spanRing[r % RING_BUFFER_SIZE];
+                rgbRows[validRows]    = rowBuffer[r % RING_BUFFER_SIZE];
+                validRows++;
+            }
+        }
+
+        //Skalierung + Ausgabe der fertigen LCD-Zeile
+        if (validRows > 0)
+        {
+            //Dieser Puffer wurde vor zwei Zeilen gesendet; lcd_draw_row_async hat sein Ende bereits abgewartet
+            uint16_t *outputRow = outputLine[outIdx];
+            STAGE(PIPE_SCALE);
+
+#if SCALER_BENCH
+            uint32_t tBench = getTimeStamp();
+#endif
+            // Aufruf der Skalierungsfunktion
+            if (isRgb24)
+            {
+                scale_rgb24_box_fit(outputRow, rgbRows, validRows);
+            }
+            else
+            {
+#if SCALER_COMPARE_FLOAT
+                uint32_t t0 = getTimeStamp();
+                scale_spans_box_fit(outputRow, scalerRows, validRows);
+                ticksFixed += getTimeStamp() - t0;
+
+                //Alter Pfad braucht ausgeschriebene Pixelzeilen (nicht mitgemessen)
+                for (int r = 0; r < validRows; r++) {
+                    span_row_expand(scalerRows[r]);
+                    compareRows[r] = scalerRows[r]->literal;
+                }
+                uint32_t t1 = getTimeStamp();
+                scale_line_box_fit_float(compareLine, compareRows, validRows,
+                                         srcW, scale, offsetX, displayImageWidth, pal);
+                ticksFloat += getTimeStamp() - t1;
+                scaledRows++;
+#else
+                scale_spans_box_fit(outputRow, scalerRows, validRows);
+#endif
+            }
+#if SCALER_BENCH
+            benchTicks += getTimeStamp() - tBench;
+            benchRows++;
+#endif
+
+            // Zeichnen (Ganze Zeile wird per DMA geschrieben, währenddessen geht es mit der nächsten Zeile weiter)
+            STAGE(PIPE_LCD);
+            show_row(lcdY, outputRow);
+#if PROGRESSIVE_PREVIEW
+            if (!coarseFirst)
+                show_preview(i, lcdY, outputRow, displayImageHeight);
+#endif
+            outIdx ^= 1;
+            res->outRows++;
+        }
+    }
+
+    //Restliche Zeilen nur überlesen, ohne Pixel zu schreiben (legt den Zeilenindex aller RLE-Zeilen an)
+    if (cfg->readToEnd) {
+        STAGE(PIPE_DECODE);
+        while (rowsReadTotal < srcH && bmpStatus == 0) {
+            if (bmp_skip_row(srcW) != 0)
+                bmpStatus = -1;
+            rowsReadTotal++;
+        }
+    }
+
+    //Datei kürzer als HEAD_HASH_BYTES: Schlüssel steht erst am Dateiende fest, es fehlen höchstens die Zeilen der letzten Box
+    if (cfg->useCache && !cacheKeyKnown && !cacheHit && bmpStatus == 0) {
+        const char *rest;
+        int n;
+        while ((n = nextSpan(&rest)) > 0)
+            consumeSpan(n);
+    }
+    //Rest der Datei wird nicht gebraucht → Übertragung abbrechen statt ihn zu dekodieren
+    stopFile();
+
+    //Nur vollständig und fehlerfrei angezeigte Bilder cachen (kurze Dateien: Hash erst am Dateiende fertig)
+    if (!cacheKeyKnown)
+        cacheKeyKnown = getHeadHash(&cacheKey);
+    if (cfg->useCache && !cacheHit) {
+        if (bmpStatus == 0 && cacheKeyKnown)
+            frame_cache_commit(cacheKey);
+        else
+            frame_cache_cancel();
+    }
+    res->cacheHit = cacheHit;
+    res->cacheKey = cacheKey;
+    res->cacheKeyKnown = cacheKeyKnown;
+
+    //Letzte Zeile muss raus sein, bevor wieder über GUI_* gezeichnet wird
+    STAGE(PIPE_LCD);
+    lcd_wait_idle();
+
+#if SCALER_BENCH
+    //Skalier-Durchsatz dieses Bildes: Ausgabezeilen/s und gelesene Quellpixel/s
+    if (benchTicks > 0) {
+        char benchBuf[64];
+        uint32_t ticksPerSec = TICKS_PER_US * 1000000u;
+        uint64_t srcPixels = (uint64_t)benchRows * boxSize * srcW;
+        snprintf(benchBuf, sizeof(benchBuf), "%s Z/s:%u KPix/s:%u",
+                 isRgb24 ? "24bpp" : "RLE8",
+                 (unsigned)((uint64_t)benchRows * ticksPerSec / benchTicks),
+                 (unsigned)(srcPixels * ticksPerSec / benchTicks / 1000u));
+        Coordinate pos = {0, LCD_HEIGHT - 32};
+        GUI_disStr(pos, benchBuf, &Font16, WHITE, RED);
+    }
+#endif
+
+#if SCALER_COMPARE_FLOAT
+    //Vergleich Festkomma- vs. Float-Kernel in Zeilen pro Sekunde
+    if (ticksFixed > 0 && ticksFloat > 0) {
+        char cmpBuf[64];
+        uint32_t ticksPerSec = TICKS_PER_US * 1000000u;
+        snprintf(cmpBuf, sizeof(cmpBuf), "Scaler Z/s neu:%u alt:%u",
+                 (unsigned)((uint64_t)scaledRows * ticksPerSec / ticksFixed),
+                 (unsigned)((uint64_t)scaledRows * ticksPerSec / ticksFloat));
+        Coordinate pos = {0, LCD_HEIGHT - 16};
+        GUI_disStr(pos, cmpBuf, &Font16, WHITE, RED);
+    }
+#endif
+
+    return (bmpStatus == 0) ? EOK : NOK;
+}
@@ -1,156 +1,290 @@
 #include "rle_decoder.h"
 #include "input.h"
-#include "LCD_GUI.h"
-#include "fontsFLASH.h"
+#include "pixel_unpack.h"
+#include <stdbool.h>
 #include <stdio.h>
 
-static int curX = 0;
-static int curY = 0;
-static int height = 0;
-static int ended = 0;
+/*
+ * Streaming-Decoder für RLE8 (BI_RLE8) und RLE4 (BI_RLE4) als Zustandsautomat über Zeilen.
+ * RLE4: ein Lauf wechselt zwischen den beiden Nibbles von b2, Absolute Mode hat
+ * b2 gepackte Nibbles. Beides wird wortweise in unpackBuf ausgepackt und als
+ * Literal weitergegeben, gleiche Nibbles bleiben ein echter Lauf.
+ * Zustand zwischen zwei Zeilen:
+ *  - pendingRows: durch Delta (dy) übersprungene Zeilen → komplett Hintergrund
+ *  - resumeX:     Spalte, an der die nächste echte Zeile nach einem Delta beginnt
+ *  - eof:         End Of Bitmap gelesen → alle weiteren Zeilen Hintergrund
+ * Übersprungene Spalten/Zeilen werden als Hintergrund-Span abgelegt, ohne
+ * den Pixelspeicher zu beschreiben. Mit row == NULL gehen die Spans an einen
+ * SpanSink (Streaming) oder die Zeile wird nur geparst (sink == NULL).
+ */
+
+typedef struct {
+    int  width;
+    int  height;
+    int  row;          // Anzahl bereits gelieferter Zeilen (von unten gezählt)
+    int  resumeX;
+    int  pendingRows;
+    bool eof;
+    bool nibbles;      // RLE4
+} RleState;
+
+static RleState rle;
+static uint8_t unpackBuf[UNPACK_CHUNK]; //RLE4: ausgepackte Indizes (ein Opcode hat höchstens 255 Pixel)
 
-//rleError()   Kleine Hilfsfunktion zum Anzeigen von Fehlermeldungen am LCD
-static void rleError(const char *msg)
+//Lesezeiger direkt im Eingabepuffer (nextSpan), spart den Funktionsaufruf pro Byte
+static const uint8_t *g_in = NULL;
+static int g_inLeft = 0;
+static int g_inUsed = 0;
+
+//Gelesene Bytes an input.c zurückmelden, danach darf wieder nextChar() benutzt werden
+static void in_sync(void)
 {
-    GUI_clear(WHITE);
-    Coordinate tl = { 10, 10 };
-    GUI_disStr(tl, msg, &Font16, WHITE, RED);
+    if (g_inUsed > 0)
+        consumeSpan(g_inUsed);
+    g_inUsed = 0;
+    g_inLeft = 0;
 }
 
-/*rle_reset_with_height()
- *   Wird bei jedem neuen BMP-Bild vom Reader aufgerufen.
- *   Setzt Decoder-Zustände korrekt zurück.
- */
-void rle_reset_with_height(int h)
+static inline int in_refill(void)
 {
-    height = h;
-    curX = 0;
-    curY = 0;
-    ended = 0;
+    const char *data;
+    in_sync();
+    g_inLeft = nextSpan(&data);
+    g_in = (const uint8_t *)data;
+    return g_inLeft;
 }
 
-//rle_reset() – Reset ohne Höhe
-void rle_reset(void)
+static inline int in_byte(void)
 {
-    curX = 0;
-    curY = 0;
-    ended = 0;
+    if (g_inLeft == 0 && in_refill() == 0)
+        return EOF;
+    g_inLeft--;
+    g_inUsed++;
+    return *g_in++;
 }
 
-//rle_decode_row()  Dekodiert EINE Zeile aus einem RLE8-komprimierten BMP.
-int rle_decode_row(uint8_t *row, int width)
+//Span an der Zeilenbreite abschneiden (SpanRow macht das in span_put_*, der Sink nicht)
+static inline int clip_len(int x, int len)
 {
-    if (ended)                  // = 0   → Zeile erfolgreich dekodiert / = 1   → End-of-Bitmap wurde erreicht (weitere Zeilen = leer) / = -1  → Fehler (EOF oder ungültiger Stream)
+    if (x >= rle.width)
+        return 0;
+    return (x + len > rle.width) ? rle.width - x : len;
+}
+
+//n Bytes direkt aus dem Eingabepuffer übernehmen (row/sink) oder nur überspringen
+static int in_block(SpanRow *row, const SpanSink *sink, int x, int n)
+{
+    while (n > 0)
     {
-        for (int i = 0; i < width; i++)
-            row[i] = 0;
-        return 1;
+        if (g_inLeft == 0 && in_refill() == 0)
+            return -1;
+
+        int chunk = (n < g_inLeft) ? n : g_inLeft;
+        if (row != NULL)
+            span_put_literal(row, x, g_in, chunk);
+        else if (sink != NULL && clip_len(x, chunk) > 0)
+            sink->literal(x, g_in, clip_len(x, chunk));
+        g_in     += chunk;
+        g_inLeft -= chunk;
+        g_inUsed += chunk;
+        x        += chunk;
+        n        -= chunk;
     }
+    return 0;
+}
 
-    /* Zeile löschen */
-    for (int i = 0; i < width; i++)
-        row[i] = 0;
+static inline void put_run(SpanRow *row, const SpanSink *sink, int x, int len, uint8_t color)
+{
+    if (row != NULL)
+        span_put_run(row, x, len, color);
+    else if (sink != NULL && clip_len(x, len) > 0)
+        sink->run(x, clip_len(x, len), color);
+}
 
-    curX = 0;
+//Ausgepackte Pixel aus unpackBuf weitergeben
+static inline void put_unpacked(SpanRow *row, const SpanSink *sink, int x, int n)
+{
+    if (row != NULL)
+        span_put_literal(row, x, unpackBuf, n);
+    else if (sink != NULL && clip_len(x, n) > 0)
+        sink->literal(x, unpackBuf, clip_len(x, n));
+}
 
-    //Hauptschleife: Wir dekodieren so lange, bis ein "End-of-Line" (00 00) kommt.
-    while (curY < height)                   //c1:Anzahl Pixel  / c2:Farbindex
+//RLE4 Absolute Mode: n gepackte Nibbles ((n + 1) / 2 Bytes) blockweise aus dem Eingabepuffer auspacken
+static int in_nibbles(SpanRow *row, const SpanSink *sink, int x, int n)
+{
+    while (n > 0)
     {
-        int c1 = nextChar();       
-        int c2 = nextChar();
-
-        if (c1 == EOF || c2 == EOF)
-        {
-            rleError("Fehler: RLE EOF");
+        if (g_inLeft == 0 && in_refill() == 0)
             return -1;
+
+        int bytes = (n + 1) / 2;
+        if (bytes > g_inLeft) bytes = g_inLeft;
+        int pixels = (2 * bytes < n) ? 2 * bytes : n;
+        if (row != NULL || sink != NULL) {
+            unpack_4bpp(unpackBuf, g_in, pixels);
+            put_unpacked(row, sink, x, pixels);
         }
+        g_in     += bytes;
+        g_inLeft -= bytes;
+        g_inUsed += bytes;
+        x        += pixels;
+        n        -= pixels;
+    }
+    return 0;
+}
 
-        //ENCODED MODE
-        if (c1 > 0)
-        {
-            uint8_t color = (uint8_t)c2;
+void rle_reset(int width, int height, bool nibbles)
+{
+    in_sync();
+    rle.width       = width;
+    rle.height      = height;
+    rle.row         = 0;
+    rle.resumeX     = 0;
+    rle.pendingRows = 0;
+    rle.eof         = false;
+    rle.nibbles     = nibbles;
+}
 
-            for (int i = 0; i < c1; i++)
-            {
-                if (curX < width)
-                    row[curX] = color;
-                curX++;
+void rle_mark(RleMark *mark)
+{
+    mark->resumeX     = rle.resumeX;
+    mark->pendingRows = (uint8_t)rle.pendingRows;
+    mark->eof         = rle.eof;
+}
+
+//Nach einem Sprung im Datenstrom (seekFile): alter Lesezeiger ist ungültig, Breite/Höhe bleiben
+void rle_restore(const RleMark *mark, int row)
+{
+    in_sync();
+    rle.row         = row;
+    rle.resumeX     = mark->resumeX;
+    rle.pendingRows = mark->pendingRows;
+    rle.eof         = mark->eof;
+}
+
+//Eine Zeile dekodieren (in row oder an sink) oder nur die Opcodes überlesen (beide NULL)
+static int decode_row(SpanRow *row, const SpanSink *sink)
+{
+    int width = rle.width;
+    int x = 0;
+
+    rle.row++;
+
+    //Zeile liegt komplett in einer Delta-Lücke, hinter End Of Bitmap oder über biHeight
+    if (rle.eof || rle.pendingRows > 0 || rle.row > rle.height)
+    {
+        if (rle.pendingRows > 0)
+            rle.pendingRows--;
+        put_run(row, sink, 0, width, SPAN_BACKGROUND);
+        return 0;
+    }
+
+    //Fortsetzung nach Delta mit dy > 0: Anfang der Zeile ist Hintergrund
+    if (rle.resumeX > 0)
+    {
+        x = rle.resumeX;
+        rle.resumeX = 0;
+        put_run(row, sink, 0, x, SPAN_BACKGROUND);
+    }
+
+    while (1)
+    {
+        int b1 = in_byte();
+        int b2 = in_byte();
+
+        if (b1 == EOF || b2 == EOF)
+            return -1;
+
+        // ENCODED MODE (b1 > 0)  / b1 = Anzahl wiederholungen , b2 = Farbindex (RLE4: zwei Indizes im Wechsel)
+        if (b1 > 0)
+        {
+            if (!rle.nibbles)
+                put_run(row, sink, x, b1, (uint8_t)b2);
+            else if ((b2 >> 4) == (b2 & 0x0F))
+                put_run(row, sink, x, b1, (uint8_t)(b2 & 0x0F));
+            else if (row != NULL || sink != NULL) {
+                unpack_pair(unpackBuf, (uint8_t)(b2 >> 4), (uint8_t)(b2 & 0x0F), b1);
+                put_unpacked(row, sink, x, b1);
             }
+            x += b1;
+            continue;
         }
-        else //ESCAPE CODES
-        {
-             
 
-            //END OF LINE: 00 00
-            if (c2 == 0)        //c2 = 0 → End of Line
-            {
-                curY++; // Nächste BMP-Zeile
-                return 0; // Eine LCD-Zeile fertig
-            }
+        // ESCAPE MODE (b1 == 0)
+        if (b2 == RLE_ESC_EOL) //0,0 → End Of Line
+            break;
 
-            //END OF BITMAP: 00 01
-            else if (c2 == 1)       //c2 = 1 → End of Bitmap
-            {
-                ended = 1;
-                return 0;
-            }
+        if (b2 == RLE_ESC_EOB) //0,1 → End Of Bitmap
+        {
+            rle.eof = true;
+            break;
+        }
 
-            //DELTA MODE: 00 02 dx dy
-            else if (c2 == 2)       //c2 = 2 → Delta (dx, dy)
-            {
-                int dx = nextChar();
-                int dy = nextChar();
-
-                if (dx == EOF || dy == EOF)
-                {
-                    rleError("Fehler: RLE Delta EOF");
-                    return -1;
-                }
-
-                curX += dx;
-                curY += dy;
-
-                if (curX >= width) curX = width - 1; //Seitliche Begrenzung
-                if (curY >= height) //Wenn Delta die letzte Zeile überschreitet → Bitmap zu Ende
-                {
-                    ended = 1;
-                    return 0;
-                }
-            }
+        if (b2 == RLE_ESC_DELTA) //0,2,dx,dy → Cursor um dx nach rechts und dy Zeilen weiter
+        {
+            int dx = in_byte();
+            int dy = in_byte();
+            if (dx == EOF || dy == EOF)
+                return -1;
 
-            //ABSOLUTE MODE: 00 NN <NN Pixel>
-            else
+            if (dy == 0)
             {
-                int count = c2;
-                int padding = (count & 1); // Padding bei ungerader Anzahl
-
-                for (int i = 0; i < count; i++)
-                {
-                    int val = nextChar();
-                    if (val == EOF)
-                    {
-                        rleError("Fehler: ABS EOF");
-                        return -1;
-                    }
-
-                    if (curX < width)
-                        row[curX] = (uint8_t)val;
-
-                    curX++;
-                }
-
-                if (padding) //Padding-Byte verwerfen
-                    nextChar();
+                put_run(row, sink, x, dx, SPAN_BACKGROUND);
+                x += dx;
+                continue;
             }
+
+            //Rest dieser Zeile und dy-1 ganze Zeilen sind Hintergrund
+            rle.pendingRows = dy - 1;
+            rle.resumeX = x + dx;
+            break;
         }
 
-        //Wenn row[] voll ist → nächste Zeile beginnen
-        if (curX >= width)
+        // ABSOLUTE MODE → b2 Pixel blockweise direkt aus dem Eingabepuffer, Padding auf Wortgrenze
+        if (rle.nibbles)
         {
-            curY++;
-            return 0;
+            if (in_nibbles(row, sink, x, b2) != 0)
+                return -1;
+            x += b2;
+
+            if ((((b2 + 1) / 2) & 1) && in_byte() == EOF)
+                return -1;
+            continue;
         }
+
+        if (in_block(row, sink, x, b2) != 0)
+            return -1;
+        x += b2;
+
+        if ((b2 & 1) && in_byte() == EOF)
+            return -1;
     }
 
+    //Rest der Zeile (EOL, End Of Bitmap, Delta) = Hintergrund
+    if (x < width)
+        put_run(row, sink, x, width - x, SPAN_BACKGROUND);
+
     return 0;
 }
+
+int rle_decode_row(SpanRow *row)
+{
+    int res = decode_row(row, NULL);
+    in_sync();
+    return res;
+}
+
+int rle_skip_row(void)
+{
+    int res = decode_row(NULL, NULL);
+    in_sync();
+    return res;
+}
+
+int rle_stream_row(const SpanSink *sink)
+{
+    int res = decode_row(NULL, sink);
+    in_sync();
+    return res;
+}
@@ -1,61 +1,953 @@
 #include "scaler.h"
 #include "lcd_output.h"
-#include <math.h>     // Wichtig für floorf, ceilf
+#include "palette.h"
+#include <math.h>     // Wichtig für floorf, ceilf (nur in scaler_init)
 #include <stdint.h>   // Wichtig für uint8_t, uint16_t
 #include <stddef.h>   // Für NULL
- 
-void scale_line_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount,
-                        int srcW, float scale, int offsetX, int displayImageWidth,
-                        RGBQUAD *pal)
+#include <string.h>   // Für memset
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "stm32f4xx.h" // CMSIS-SIMD-Intrinsics (__UXTAB16)
+#endif
+
+#define Q16_ONE 65536u
+
+//24 Bit: zwei 8-Bit-Kanäle teilen sich ein Wort (R in Bit 16..31, B in Bit 0..15),
+//bis 256 Pixel (256 * 255 < 65536) läuft dabei kein Feld über
+#define RGB24_LANE_BATCH 256
+
+//Ein Eintrag pro sichtbarer Ausgabespalte
+typedef struct {
+    uint16_t srcStart;  // erste Quellspalte der Box
+    uint16_t boxWidth;  // Anzahl Quellspalten der Box
+    uint32_t weight;    // 1 / (boxWidth * boxRows) in Q32 (box_reciprocal)
+} ColumnSpan;
+
+//Tabellen-Zustand für das aktuelle Bild (wird in scaler_init gesetzt)
+static ColumnSpan colSpans[SCALER_LINE_WIDTH];
+static int spanOffsetX = 0;
+static int spanCount = 0;
+static int spanBoxRows = 1;
+static int spanIdentity = 0; // 1:1 → keine Mittelung, direkt pal565
+
+//Hochskalieren (scale > 1)
+typedef struct {
+    uint16_t x0;    // linke Quellspalte
+    uint8_t  step;  // 1 = rechter Nachbar x0 + 1, 0 = am rechten Rand
+    uint8_t  fx;    // Anteil des rechten Nachbarn in 1/256
+} UpColumn;
+
+static ScalerMode upMode = SCALER_DOWN;
+static int upFactor = 1;           // ganzzahliger Faktor (SCALER_UP_INTEGER)
+static uint32_t upInvQ16 = Q16_ONE; // 1 / scale in Q16 (SCALER_UP_BILINEAR)
+static UpColumn upCols[SCALER_LINE_WIDTH];
+static uint32_t upLines[2][SCALER_LINE_WIDTH]; // horizontal interpolierte Quellzeilen (0x00RRGGBB), Index = Quellzeile & 1
+
+//Exakte Verkleinerung um 2, 3, 4 oder 8 → spezialisierte Kernel (NULL = generischer Kernel)
+typedef void (*SpanRowKernel)(const SpanRow *row);
+typedef void (*Rgb24LineKernel)(uint16_t *line, uint8_t **inputRows, int rowCount);
+
+static int intFactor = 0;
+static SpanRowKernel intSpanKernel = NULL;
+static Rgb24LineKernel intRgb24Kernel = NULL;
+
+static void select_int_kernels(int factor, int boxRows);
+
+//Spalten-Akkumulatoren für den Span-Kernel (6-Bit-Kanäle, volle Breite)
+static uint32_t accR[SCALER_LINE_WIDTH];
+static uint32_t accG[SCALER_LINE_WIDTH];
+static uint32_t accB[SCALER_LINE_WIDTH];
+
+//Q32-Kehrwert, gerundet (n = 1 → 2^32 - 1, passt sonst nicht in 32 Bit)
+static uint32_t box_reciprocal(uint32_t n)
+{
+    if (n <= 1)
+        return 0xFFFFFFFFu;
+    return (uint32_t)((((uint64_t)1 << 32) + n / 2) / n);
+}
+
+//Mittelwert sum / n über den Kehrwert, auf die nächste ganze Zahl gerundet (UMULL statt UDIV).
+//Volle Box ergibt genau den Maximalwert, sonst höchstens 1 LSB neben dem exakt gerundeten Mittel (nur sehr große Boxen, knapp an .5)
+static inline uint32_t box_mean(uint32_t sum, uint32_t weight)
+{
+    return (uint32_t)(((uint64_t)sum * weight + 0x80000000u) >> 32);
+}
+
+void scaler_init(int srcW, float scale, int offsetX, int displayImageWidth, int boxRows)
+{
+    if (offsetX < 0) offsetX = 0;
+    if (displayImageWidth > SCALER_LINE_WIDTH - offsetX) displayImageWidth = SCALER_LINE_WIDTH - offsetX;
+    if (displayImageWidth < 0) displayImageWidth = 0;
+    if (boxRows < 1) boxRows = 1;
+
+    spanOffsetX = offsetX;
+    spanCount   = displayImageWidth;
+    spanBoxRows = boxRows;
+    spanIdentity = (scale == 1.0f) && (boxRows == 1);
+
+    upMode = SCALER_DOWN;
+    if (scale > 1.0f)
+    {
+        //Exakter ganzzahliger Faktor → Pixelwiederholung, sonst bilinear
+        int f = (int)(scale + 0.5f);
+        if (f >= 2 && fabsf(scale - (float)f) < 1e-4f)
+        {
+            upMode = SCALER_UP_INTEGER;
+            upFactor = f;
+        }
+        else
+        {
+            upMode = SCALER_UP_BILINEAR;
+            upInvQ16 = (uint32_t)(65536.0f / scale + 0.5f);
+
+            for (int i = 0; i < spanCount; i++)
+            {
+                //Pixelmitten aufeinander abbilden: srcX = (i + 0.5) / scale - 0.5
+                int32_t pos = (int32_t)((uint32_t)i * upInvQ16 + upInvQ16 / 2) - (int32_t)(Q16_ONE / 2);
+                if (pos < 0) pos = 0;
+
+                int x0 = pos >> 16;
+                if (x0 >= srcW - 1)
+                {
+                    upCols[i].x0   = (uint16_t)(srcW - 1);
+                    upCols[i].step = 0;
+                    upCols[i].fx   = 0;
+                }
+                else
+                {
+                    upCols[i].x0   = (uint16_t)x0;
+                    upCols[i].step = 1;
+                    upCols[i].fx   = (uint8_t)(pos >> 8);
+                }
+            }
+        }
+    }
+
+    //Box-Breite ist für das ganze Bild gleich
+    int boxWidth = (int)ceilf(1.0f / scale);
+    if (boxWidth < 1) boxWidth = 1;
+
+    for (int i = 0; i < spanCount; i++)
+    {
+        //Inverse Mapping: Ausgabespalte → srcX (Position im Originalbild)
+        int srcX_start = (int)floorf((float)i / scale);
+        int srcX_end   = srcX_start + boxWidth;
+
+        //Gültige Grenzen sicherstellen
+        if (srcX_end > srcW) srcX_end = srcW;
+        if (srcX_start >= srcW) srcX_start = srcW - 1;
+        if (srcX_start < 0) srcX_start = 0;
+
+        int w = srcX_end - srcX_start;
+        if (w < 1) w = 1;
+
+        colSpans[i].srcStart = (uint16_t)srcX_start;
+        colSpans[i].boxWidth = (uint16_t)w;
+        colSpans[i].weight   = box_reciprocal((uint32_t)(w * boxRows));
+    }
+
+    //Ganzzahliger Verkleinerungsfaktor → spezialisierten Kernel einmal pro Bild wählen
+    intFactor = 0;
+    intSpanKernel = NULL;
+    intRgb24Kernel = NULL;
+    if (scale < 1.0f && !spanIdentity)
+    {
+        int f = (int)(1.0f / scale + 0.5f);
+        if (fabsf(scale * (float)f - 1.0f) < 1e-4f && srcW >= f * spanCount)
+            select_int_kernels(f, boxRows);
+    }
+}
+
+//6-Bit-Mittelwerte (aus palPacked) → RGB565
+static inline uint16_t avg6_to_16(uint32_t r6, uint32_t g6, uint32_t b6)
+{
+    return (uint16_t)(((r6 >> 1) << 11) | (g6 << 5) | (b6 >> 1));
+}
+
+//Unalignierter 32-Bit-Zugriff (B,G,R,nächstes B), wird auf dem M4 zu einem einzelnen LDR
+static inline uint32_t load_u32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//acc + Bytes 0 und 2 von x in zwei 16-Bit-Feldern (Cortex-M4: ein UXTAB16-Befehl)
+static inline uint32_t uxtab16(uint32_t acc, uint32_t x)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __UXTAB16(acc, x);
+#else
+    return acc + (x & 0x00FF00FFu);
+#endif
+}
+
+//8-Bit-Mittelwerte → RGB565
+static inline uint16_t avg8_to_16(uint32_t r8, uint32_t g8, uint32_t b8)
+{
+    return (uint16_t)(((r8 >> 3) << 11) | ((g8 >> 2) << 5) | (b8 >> 3));
+}
+
+void scale_line_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount)
+{
+    int destX = 0;
+
+    //Linker Rand (Letterboxing) → Schwarz
+    for (; destX < spanOffsetX; destX++)
+        outBuf[destX] = 0;
+
+    if (spanIdentity)
+    {
+        //1:1 → jeder Quellpixel ist genau ein Ausgabepixel
+        const uint8_t *src = inputRows[0];
+        for (int i = 0; i < spanCount; i++, destX++)
+            outBuf[destX] = pal565[src[i]];
+    }
+    else
+    {
+        for (int i = 0; i < spanCount; i++, destX++)
+        {
+            const ColumnSpan *span = &colSpans[i];
+            int boxWidth = span->boxWidth;
+
+            // Box-Averaging, Wir mitteln RGB über alle Pixel im Box-Bereich
+            uint32_t rSum = 0;
+            uint32_t gSum = 0;
+            uint32_t bSum = 0;
+
+            if (boxWidth * rowCount <= PAL_PACK_BATCH)
+            {
+                //Ganze Box passt in ein gepacktes Wort → eine Addition pro Pixel
+                uint32_t packed = 0;
+                for (int r = 0; r < rowCount; r++)
+                {
+                    const uint8_t *src = inputRows[r] + span->srcStart;
+                    for (int k = 0; k < boxWidth; k++)
+                        packed += palPacked[src[k]];
+                }
+                rSum = PAL_PACK_R(packed);
+                gSum = PAL_PACK_G(packed);
+                bSum = PAL_PACK_B(packed);
+            }
+            else
+            {
+                //Große Box → alle PAL_PACK_BATCH Pixel in die breiten Summen auspacken
+                uint32_t packed = 0;
+                int n = 0;
+                for (int r = 0; r < rowCount; r++)
+                {
+                    const uint8_t *src = inputRows[r] + span->srcStart;
+                    for (int k = 0; k < boxWidth; k++)
+                    {
+                        packed += palPacked[src[k]];
+                        if (++n == PAL_PACK_BATCH)
+                        {
+                            rSum += PAL_PACK_R(packed);
+                            gSum += PAL_PACK_G(packed);
+                            bSum += PAL_PACK_B(packed);
+                            packed = 0;
+                            n = 0;
+                        }
+                    }
+                }
+                rSum += PAL_PACK_R(packed);
+                gSum += PAL_PACK_G(packed);
+                bSum += PAL_PACK_B(packed);
+            }
+
+            //Am unteren Bildrand ist die Box evtl. niedriger → Gewicht neu bestimmen
+            uint32_t weight = span->weight;
+            if (rowCount != spanBoxRows)
+                weight = box_reciprocal((uint32_t)(boxWidth * rowCount));
+
+            //Mittelwert über den Q32-Kehrwert → Anti-Aliasing ohne Division
+            outBuf[destX] = avg6_to_16(box_mean(rSum, weight),
+                                       box_mean(gSum, weight),
+                                       box_mean(bSum, weight));
+        }
+    }
+
+    //Rechter Rand (Letterboxing) → Schwarz
+    for (; destX < SCALER_LINE_WIDTH; destX++)
+        outBuf[destX] = 0;
+}
+
+//Summe von n Literal-Pixeln in die Akkumulatoren von Spalte col
+static void add_literal(int col, const uint8_t *src, int n)
+{
+    while (n > 0)
+    {
+        int chunk = (n > PAL_PACK_BATCH) ? PAL_PACK_BATCH : n;
+        uint32_t packed = 0;
+        for (int k = 0; k < chunk; k++)
+            packed += palPacked[src[k]];
+
+        accR[col] += PAL_PACK_R(packed);
+        accG[col] += PAL_PACK_G(packed);
+        accB[col] += PAL_PACK_B(packed);
+        src += chunk;
+        n   -= chunk;
+    }
+}
+
+//Spalten überspringen, die vollständig links von x0 enden (Spans einer Zeile sind aufsteigend)
+static inline int acc_seek(int col, int x0)
+{
+    while (col < spanCount && colSpans[col].srcStart + colSpans[col].boxWidth <= x0)
+        col++;
+    return col;
+}
+
+//Lauf [x0, x1) in einer Farbe auf alle überlappten Ausgabespalten verteilen
+static int acc_run(int col, int x0, int x1, uint8_t color)
+{
+    col = acc_seek(col, x0);
+
+    uint32_t p  = palPacked[color];
+    uint32_t r6 = PAL_PACK_R(p);
+    uint32_t g6 = PAL_PACK_G(p);
+    uint32_t b6 = PAL_PACK_B(p);
+
+    for (int c = col; c < spanCount && colSpans[c].srcStart < x1; c++)
+    {
+        int cs = colSpans[c].srcStart;
+        int ce = cs + colSpans[c].boxWidth;
+        uint32_t overlap = (uint32_t)(((x1 < ce) ? x1 : ce) - ((x0 > cs) ? x0 : cs));
+
+        accR[c] += overlap * r6;
+        accG[c] += overlap * g6;
+        accB[c] += overlap * b6;
+    }
+    return col;
+}
+
+//Literal-Pixel [x0, x1) verteilen, src zeigt auf den Pixel an x0
+static int acc_literal(int col, int x0, int x1, const uint8_t *src)
+{
+    col = acc_seek(col, x0);
+
+    for (int c = col; c < spanCount && colSpans[c].srcStart < x1; c++)
+    {
+        int cs = colSpans[c].srcStart;
+        int ce = cs + colSpans[c].boxWidth;
+        int from = (x0 > cs) ? x0 : cs;
+        int to   = (x1 < ce) ? x1 : ce;
+
+        add_literal(c, src + (from - x0), to - from);
+    }
+    return col;
+}
+
+//Eine Span-Zeile auf alle überlappten Ausgabespalten verteilen
+static void accumulate_span_row(const SpanRow *row)
+{
+    int col = 0;
+
+    for (int i = 0; i < row->count; i++)
+    {
+        const RowSpan *s = &row->spans[i];
+        int x0 = s->x;
+        int x1 = s->x + s->len;
+
+        if (s->color != SPAN_LITERAL)
+            col = acc_run(col, x0, x1, (uint8_t)s->color);
+        else
+            col = acc_literal(col, x0, x1, row->literal + x0);
+    }
+}
+
+//1:1 → Spans direkt als RGB565 ausgeben
+static void render_span_row_identity(uint16_t *line, const SpanRow *row)
+{
+    for (int i = 0; i < row->count; i++)
+    {
+        const RowSpan *s = &row->spans[i];
+        int x1 = s->x + s->len;
+        if (x1 > spanCount) x1 = spanCount;
+
+        if (s->color != SPAN_LITERAL)
+        {
+            uint16_t c = pal565[s->color];
+            for (int x = s->x; x < x1; x++)
+                line[x] = c;
+        }
+        else
+        {
+            for (int x = s->x; x < x1; x++)
+                line[x] = pal565[row->literal[x]];
+        }
+    }
+}
+
+void scale_spans_box_fit(uint16_t *outBuf, SpanRow **inputRows, int rowCount)
+{
+    //Letterboxing links und rechts → Schwarz
+    for (int x = 0; x < spanOffsetX; x++)
+        outBuf[x] = 0;
+    for (int x = spanOffsetX + spanCount; x < SCALER_LINE_WIDTH; x++)
+        outBuf[x] = 0;
+
+    uint16_t *line = outBuf + spanOffsetX;
+
+    if (spanIdentity)
+    {
+        render_span_row_identity(line, inputRows[0]);
+        return;
+    }
+
+    memset(accR, 0, (size_t)spanCount * sizeof(accR[0]));
+    memset(accG, 0, (size_t)spanCount * sizeof(accG[0]));
+    memset(accB, 0, (size_t)spanCount * sizeof(accB[0]));
+
+    if (intSpanKernel != NULL)
+    {
+        //Alle Boxen gleich groß → ein Gewicht für die ganze Zeile
+        uint32_t weight = box_reciprocal((uint32_t)(intFactor * rowCount));
+
+        for (int r = 0; r < rowCount; r++)
+            intSpanKernel(inputRows[r]);
+
+        for (int i = 0; i < spanCount; i++)
+            line[i] = avg6_to_16(box_mean(accR[i], weight),
+                                 box_mean(accG[i], weight),
+                                 box_mean(accB[i], weight));
+        return;
+    }
+
+    for (int r = 0; r < rowCount; r++)
+        accumulate_span_row(inputRows[r]);
+
+    //Spans decken jede Zeile lückenlos ab → jede Spalte hat boxWidth * rowCount Pixel
+    for (int i = 0; i < spanCount; i++)
+    {
+        uint32_t weight = colSpans[i].weight;
+        if (rowCount != spanBoxRows)
+            weight = box_reciprocal((uint32_t)(colSpans[i].boxWidth * rowCount));
+
+        line[i] = avg6_to_16(box_mean(accR[i], weight),
+                             box_mean(accG[i], weight),
+                             box_mean(accB[i], weight));
+    }
+}
+
+//n Pixel ab src aufsummieren: R/B gepackt per SIMD, G einzeln
+static inline void sum_rgb24(const uint8_t *src, int n, uint32_t *rb, uint32_t *g)
+{
+    uint32_t rbSum = 0;
+    uint32_t gSum = 0;
+    for (int k = 0; k < n; k++, src += 3)
+    {
+        uint32_t p = load_u32(src);
+        rbSum = uxtab16(rbSum, p);
+        gSum += (p >> 8) & 0xFFu;
+    }
+    *rb = rbSum;
+    *g  = gSum;
+}
+
+//1:1 → 4 Pixel aus 3 Wörtern auf einmal nach RGB565
+static void convert_rgb24_row(uint16_t *line, const uint8_t *src, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4, src += 12)
+    {
+        uint32_t w0 = load_u32(src);     // B0 G0 R0 B1
+        uint32_t w1 = load_u32(src + 4); // G1 R1 B2 G2
+        uint32_t w2 = load_u32(src + 8); // R2 B3 G3 R3
+
+        line[i]     = (uint16_t)(((w0 >> 8) & 0xF800u) | ((w0 >> 5) & 0x07E0u) | ((w0 >> 3) & 0x001Fu));
+        line[i + 1] = (uint16_t)((w1 & 0xF800u) | ((w1 << 3) & 0x07E0u) | ((w0 >> 27) & 0x001Fu));
+        line[i + 2] = (uint16_t)(((w2 << 8) & 0xF800u) | ((w1 >> 21) & 0x07E0u) | ((w1 >> 19) & 0x001Fu));
+        line[i + 3] = (uint16_t)(((w2 >> 16) & 0xF800u) | ((w2 >> 13) & 0x07E0u) | ((w2 >> 11) & 0x001Fu));
+    }
+    for (; i < n; i++, src += 3)
+        line[i] = (uint16_t)(((src[2] & 0xF8u) << 8) | ((src[1] & 0xFCu) << 3) | (src[0] >> 3));
+}
+
+void scale_rgb24_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount)
+{
+    //Letterboxing links und rechts → Schwarz
+    for (int x = 0; x < spanOffsetX; x++)
+        outBuf[x] = 0;
+    for (int x = spanOffsetX + spanCount; x < SCALER_LINE_WIDTH; x++)
+        outBuf[x] = 0;
+
+    uint16_t *line = outBuf + spanOffsetX;
+
+    if (spanIdentity)
+    {
+        convert_rgb24_row(line, inputRows[0], spanCount);
+        return;
+    }
+
+    if (intRgb24Kernel != NULL && intFactor * rowCount <= RGB24_LANE_BATCH)
+    {
+        intRgb24Kernel(line, inputRows, rowCount);
+        return;
+    }
+
+    for (int i = 0; i < spanCount; i++)
+    {
+        const ColumnSpan *span = &colSpans[i];
+        int boxWidth = span->boxWidth;
+        uint32_t rSum = 0;
+        uint32_t gSum = 0;
+        uint32_t bSum = 0;
+
+        for (int r = 0; r < rowCount; r++)
+        {
+            const uint8_t *src = inputRows[r] + 3 * span->srcStart;
+
+            //Breite Boxen in Blöcken, damit die 16-Bit-Felder nicht überlaufen
+            for (int k = 0; k < boxWidth; k += RGB24_LANE_BATCH)
+            {
+                int n = boxWidth - k;
+                if (n > RGB24_LANE_BATCH) n = RGB24_LANE_BATCH;
+
+                uint32_t rb, g;
+                sum_rgb24(src + 3 * k, n, &rb, &g);
+                rSum += rb >> 16;
+                bSum += rb & 0xFFFFu;
+                gSum += g;
+            }
+        }
+
+        //Am unteren Bildrand ist die Box evtl. niedriger → Gewicht neu bestimmen
+        uint32_t weight = span->weight;
+        if (rowCount != spanBoxRows)
+            weight = box_reciprocal((uint32_t)(boxWidth * rowCount));
+
+        line[i] = avg8_to_16(box_mean(rSum, weight),
+                             box_mean(gSum, weight),
+                             box_mean(bSum, weight));
+    }
+}
+
+/*
+ * Spezialisierte Kernel für exakte Verkleinerung um F = 2, 3, 4, 8.
+ * Ausgabespalte c deckt genau die Quellspalten c*F .. c*F+F-1 ab, daher
+ * entfallen Spaltentabelle und Grenzprüfungen; volle Boxen werden über die
+ * PACK_SUM_F / RGB24_SUM_F Makros vollständig ausgerollt summiert.
+ */
+#define PACK_SUM_2(s) (palPacked[(s)[0]] + palPacked[(s)[1]])
+#define PACK_SUM_3(s) (PACK_SUM_2(s) + palPacked[(s)[2]])
+#define PACK_SUM_4(s) (PACK_SUM_2(s) + PACK_SUM_2((s) + 2))
+#define PACK_SUM_8(s) (PACK_SUM_4(s) + PACK_SUM_4((s) + 4))
+
+#define RGB24_ADD(s, rb, g) do { uint32_t p_ = load_u32(s); (rb) = uxtab16((rb), p_); (g) += (p_ >> 8) & 0xFFu; } while (0)
+#define RGB24_SUM_2(s, rb, g) RGB24_ADD((s), rb, g); RGB24_ADD((s) + 3, rb, g)
+#define RGB24_SUM_3(s, rb, g) RGB24_SUM_2((s), rb, g); RGB24_ADD((s) + 6, rb, g)
+#define RGB24_SUM_4(s, rb, g) RGB24_SUM_2((s), rb, g); RGB24_SUM_2((s) + 6, rb, g)
+#define RGB24_SUM_8(s, rb, g) RGB24_SUM_4((s), rb, g); RGB24_SUM_4((s) + 12, rb, g)
+
+static inline void acc_add_packed(int col, uint32_t packed)
+{
+    accR[col] += PAL_PACK_R(packed);
+    accG[col] += PAL_PACK_G(packed);
+    accB[col] += PAL_PACK_B(packed);
+}
+
+static inline void acc_add_color(int col, uint32_t n, uint32_t r6, uint32_t g6, uint32_t b6)
+{
+    accR[col] += n * r6;
+    accG[col] += n * g6;
+    accB[col] += n * b6;
+}
+
+//Läufe: angeschnittene Randspalten anteilig, volle Spalten mit F * Farbe
+//Literale: Randspalten über add_literal, volle Spalten ausgerollt
+#define DEFINE_SPAN_ROW_KERNEL(F)                                                   \
+static void accumulate_span_row_x##F(const SpanRow *row)                            \
+{                                                                                   \
+    const int xEnd = spanCount * (F);                                               \
+    for (int i = 0; i < row->count; i++)                                            \
+    {                                                                               \
+        const RowSpan *s = &row->spans[i];                                          \
+        int x0 = s->x;                                                              \
+        int x1 = s->x + s->len;                                                     \
+        if (x0 >= xEnd)                                                             \
+            break;                                                                  \
+        if (x1 > xEnd) x1 = xEnd;                                                   \
+                                                                                    \
+        int c = x0 / (F);                                                           \
+        int n = x1 - x0;                                                            \
+        int head = (c + 1) * (F) - x0;                                              \
+        if (head > n) head = n;                                                     \
+                                                                                    \
+        if (s->color != SPAN_LITERAL)                                               \
+        {                                                                           \
+            uint32_t p  = palPacked[s->color];                                      \
+            uint32_t r6 = PAL_PACK_R(p);                                            \
+            uint32_t g6 = PAL_PACK_G(p);                                            \
+            uint32_t b6 = PAL_PACK_B(p);                                            \
+                                                                                    \
+            acc_add_color(c++, (uint32_t)head, r6, g6, b6);                         \
+            for (n -= head; n >= (F); n -= (F), c++)                                \
+                acc_add_color(c, (F), r6, g6, b6);                                  \
+            if (n > 0)                                                              \
+                acc_add_color(c, (uint32_t)n, r6, g6, b6);                          \
+        }                                                                           \
+        else                                                                        \
+        {                                                                           \
+            const uint8_t *src = row->literal + x0;                                 \
+            if (head < (F))                                                         \
+            {                                                                       \
+                add_literal(c++, src, head);                                        \
+                src += head;                                                        \
+                n   -= head;                                                        \
+            }                                                                       \
+            for (; n >= (F); n -= (F), c++, src += (F))                             \
+                acc_add_packed(c, PACK_SUM_##F(src));                               \
+            if (n > 0)                                                              \
+                add_literal(c, src, n);                                             \
+        }                                                                           \
+    }                                                                               \
+}
+
+//R/B-Felder laufen bei F * rowCount <= RGB24_LANE_BATCH nicht über (prüft scale_rgb24_box_fit)
+#define DEFINE_RGB24_KERNEL(F)                                                      \
+static void scale_rgb24_x##F(uint16_t *line, uint8_t **inputRows, int rowCount)     \
+{                                                                                   \
+    uint32_t weight = box_reciprocal((uint32_t)((F) * rowCount));                   \
+    for (int i = 0; i < spanCount; i++)                                             \
+    {                                                                               \
+        uint32_t rb = 0;                                                            \
+        uint32_t g  = 0;                                                            \
+        for (int r = 0; r < rowCount; r++)                                          \
+        {                                                                           \
+            const uint8_t *src = inputRows[r] + 3 * (F) * i;                        \
+            RGB24_SUM_##F(src, rb, g);                                              \
+        }                                                                           \
+        line[i] = avg8_to_16(box_mean(rb >> 16, weight),                            \
+                             box_mean(g, weight),                                   \
+                             box_mean(rb & 0xFFFFu, weight));                       \
+    }                                                                               \
+}
+
+DEFINE_SPAN_ROW_KERNEL(2)
+DEFINE_SPAN_ROW_KERNEL(3)
+DEFINE_SPAN_ROW_KERNEL(4)
+DEFINE_SPAN_ROW_KERNEL(8)
+
+DEFINE_RGB24_KERNEL(2)
+DEFINE_RGB24_KERNEL(3)
+DEFINE_RGB24_KERNEL(4)
+DEFINE_RGB24_KERNEL(8)
+
+static const struct {
+    int factor;
+    SpanRowKernel spans;
+    Rgb24LineKernel rgb24;
+} intKernels[] = {
+    { 2, accumulate_span_row_x2, scale_rgb24_x2 },
+    { 3, accumulate_span_row_x3, scale_rgb24_x3 },
+    { 4, accumulate_span_row_x4, scale_rgb24_x4 },
+    { 8, accumulate_span_row_x8, scale_rgb24_x8 },
+};
+
+static void select_int_kernels(int factor, int boxRows)
+{
+    for (size_t k = 0; k < sizeof(intKernels) / sizeof(intKernels[0]); k++)
+    {
+        if (intKernels[k].factor != factor)
+            continue;
+
+        intFactor      = factor;
+        intSpanKernel  = intKernels[k].spans;
+        intRgb24Kernel = intKernels[k].rgb24;
+
+        //Tabelle ohne Float-Rundung (z.B. i / (1/3.0f) → 2.9999) → gleiche Boxen wie die Kernel
+        for (int i = 0; i < spanCount; i++)
+        {
+            colSpans[i].srcStart = (uint16_t)(i * factor);
+            colSpans[i].boxWidth = (uint16_t)factor;
+            colSpans[i].weight   = box_reciprocal((uint32_t)(factor * boxRows));
+        }
+        return;
+    }
+}
+
+int scaler_int_factor(void)
+{
+    return intFactor;
+}
+
+ScalerMode scaler_mode(void)
+{
+    return upMode;
+}
+
+void scaler_up_rows(int destY, int srcH, int *y0, int *y1, uint32_t *fy)
+{
+    if (upMode == SCALER_UP_INTEGER)
+    {
+        *y0 = *y1 = destY / upFactor;
+        *fy = 0;
+    }
+    else
+    {
+        //Wie die Spalten: Pixelmitten aufeinander abbilden
+        int32_t pos = (int32_t)((uint32_t)destY * upInvQ16 + upInvQ16 / 2) - (int32_t)(Q16_ONE / 2);
+        if (pos < 0) pos = 0;
+
+        *y0 = pos >> 16;
+        *fy = ((uint32_t)pos >> 8) & 0xFFu;
+        *y1 = *y0 + 1;
+    }
+
+    //Unterer Rand → letzte Zeile wiederholen
+    if (*y0 >= srcH - 1)
+    {
+        *y0 = *y1 = srcH - 1;
+        *fy = 0;
+    }
+}
+
+//a * (1 - f) + b * f je Kanal, R und B gemeinsam in einem Wort (f in 1/256)
+static inline uint32_t lerp_rgb(uint32_t a, uint32_t b, uint32_t f)
+{
+    uint32_t rb = ((a & 0xFF00FFu) * (256u - f) + (b & 0xFF00FFu) * f) >> 8;
+    uint32_t g  = ((a & 0x00FF00u) * (256u - f) + (b & 0x00FF00u) * f) >> 8;
+    return (rb & 0xFF00FFu) | (g & 0x00FF00u);
+}
+
+static inline uint16_t rgb888_to_16(uint32_t p)
+{
+    return (uint16_t)(((p >> 8) & 0xF800u) | ((p >> 5) & 0x07E0u) | ((p >> 3) & 0x001Fu));
+}
+
+//Letterboxing links und rechts → Schwarz, liefert den Anfang des Bildbereichs
+static uint16_t *clear_borders(uint16_t *outBuf)
+{
+    for (int x = 0; x < spanOffsetX; x++)
+        outBuf[x] = 0;
+    for (int x = spanOffsetX + spanCount; x < SCALER_LINE_WIDTH; x++)
+        outBuf[x] = 0;
+    return outBuf + spanOffsetX;
+}
+
+void scale_up_replicate_spans(uint16_t *outBuf, const SpanRow *row)
+{
+    uint16_t *line = clear_borders(outBuf);
+    int f = upFactor;
+
+    for (int i = 0; i < row->count; i++)
+    {
+        const RowSpan *s = &row->spans[i];
+        int x0 = s->x * f;
+        int x1 = (s->x + s->len) * f;
+        if (x1 > spanCount) x1 = spanCount;
+
+        if (s->color != SPAN_LITERAL)
+        {
+            //Ganzer Lauf mit einer Farbe → ein Füllvorgang über len * f Pixel
+            uint16_t c = pal565[s->color];
+            for (int x = x0; x < x1; x++)
+                line[x] = c;
+        }
+        else
+        {
+            const uint8_t *src = row->literal + s->x;
+            for (int x = x0; x < x1; src++)
+            {
+                uint16_t c = pal565[*src];
+                for (int k = 0; k < f && x < x1; k++, x++)
+                    line[x] = c;
+            }
+        }
+    }
+}
+
+void scale_up_replicate_rgb24(uint16_t *outBuf, const uint8_t *row)
+{
+    uint16_t *line = clear_borders(outBuf);
+    int f = upFactor;
+
+    for (int x = 0; x < spanCount; row += 3)
+    {
+        uint16_t c = rgb888_to_16(load_u32(row));
+        for (int k = 0; k < f && x < spanCount; k++, x++)
+            line[x] = c;
+    }
+}
+
+void scale_up_prepare_spans(SpanRow *row, int srcRow)
+{
+    uint32_t *dst = upLines[srcRow & 1];
+    span_row_expand(row);
+
+    const uint8_t *src = row->literal;
+    for (int i = 0; i < spanCount; i++)
+    {
+        const UpColumn *c = &upCols[i];
+        dst[i] = lerp_rgb(pal888[src[c->x0]], pal888[src[c->x0 + c->step]], c->fx);
+    }
+}
+
+void scale_up_prepare_rgb24(const uint8_t *row, int srcRow)
+{
+    uint32_t *dst = upLines[srcRow & 1];
+
+    for (int i = 0; i < spanCount; i++)
+    {
+        const UpColumn *c = &upCols[i];
+        const uint8_t *p = row + 3 * c->x0;
+        dst[i] = lerp_rgb(load_u32(p), load_u32(p + 3 * c->step), c->fx);
+    }
+}
+
+void scale_up_blend(uint16_t *outBuf, int y0, int y1, uint32_t fy)
+{
+    uint16_t *line = clear_borders(outBuf);
+    const uint32_t *a = upLines[y0 & 1];
+    const uint32_t *b = upLines[y1 & 1];
+
+    if (fy == 0)
+    {
+        for (int i = 0; i < spanCount; i++)
+            line[i] = rgb888_to_16(a[i]);
+        return;
+    }
+
+    for (int i = 0; i < spanCount; i++)
+        line[i] = rgb888_to_16(lerp_rgb(a[i], b[i], fy));
+}
+
+/*
+ * Streaming-Modus für Bilder breiter als der Zeilenpuffer: jede Quellzeile wird
+ * direkt beim Dekodieren in accR/G/B gefaltet, gespeichert wird nur eine LCD-Zeile
+ * Akkumulatoren. streamX erkennt den Beginn einer neuen Quellzeile (x springt zurück).
+ */
+static int streamCol = 0;
+static int streamX = 0;
+
+void scale_stream_begin(void)
+{
+    memset(accR, 0, (size_t)spanCount * sizeof(accR[0]));
+    memset(accG, 0, (size_t)spanCount * sizeof(accG[0]));
+    memset(accB, 0, (size_t)spanCount * sizeof(accB[0]));
+    streamCol = 0;
+    streamX = 0;
+}
+
+static inline int stream_col(int x)
+{
+    if (x < streamX)
+        streamCol = 0;
+    streamX = x;
+    return streamCol;
+}
+
+void scale_stream_run(int x, int len, uint8_t color)
+{
+    streamCol = acc_run(stream_col(x), x, x + len, color);
+}
+
+void scale_stream_literal(int x, const uint8_t *src, int n)
+{
+    streamCol = acc_literal(stream_col(x), x, x + n, src);
+}
+
+void scale_stream_rgb24(int x, const uint8_t *src, int n)
+{
+    int x1 = x + n;
+    int col = acc_seek(stream_col(x), x);
+    streamCol = col;
+
+    for (int c = col; c < spanCount && colSpans[c].srcStart < x1; c++)
+    {
+        int cs = colSpans[c].srcStart;
+        int ce = cs + colSpans[c].boxWidth;
+        int from = (x > cs) ? x : cs;
+        int to   = (x1 < ce) ? x1 : ce;
+
+        for (int k = from; k < to; k += RGB24_LANE_BATCH)
+        {
+            int cnt = to - k;
+            if (cnt > RGB24_LANE_BATCH) cnt = RGB24_LANE_BATCH;
+
+            uint32_t rb, g;
+            sum_rgb24(src + 3 * (k - x), cnt, &rb, &g);
+            accR[c] += rb >> 16;
+            accB[c] += rb & 0xFFFFu;
+            accG[c] += g;
+        }
+    }
+}
+
+void scale_stream_finish_spans(uint16_t *outBuf, int rowCount)
+{
+    uint16_t *line = clear_borders(outBuf);
+
+    for (int i = 0; i < spanCount; i++)
+    {
+        uint32_t weight = box_reciprocal((uint32_t)(colSpans[i].boxWidth * rowCount));
+        line[i] = avg6_to_16(box_mean(accR[i], weight),
+                             box_mean(accG[i], weight),
+                             box_mean(accB[i], weight));
+    }
+}
+
+void scale_stream_finish_rgb24(uint16_t *outBuf, int rowCount)
+{
+    uint16_t *line = clear_borders(outBuf);
+
+    for (int i = 0; i < spanCount; i++)
+    {
+        uint32_t weight = box_reciprocal((uint32_t)(colSpans[i].boxWidth * rowCount));
+        line[i] = avg8_to_16(box_mean(accR[i], weight),
+                             box_mean(accG[i], weight),
+                             box_mean(accB[i], weight));
+    }
+}
+
+#if SCALER_COMPARE_FLOAT
+void scale_line_box_fit_float(uint16_t *outBuf, uint8_t **inputRows, int rowCount,
+                              int srcW, float scale, int offsetX, int displayImageWidth,
+                              RGBQUAD *pal)
 {
     //Loop über alle 480 Pixel der LCD-Zeile
-    for (int destX = 0; destX < 480; destX++)
+    for (int destX = 0; destX < SCALER_LINE_WIDTH; destX++)
     {
         //Prüfen, ob der Pixel im sichtbaren Bereich liegt. Alles außerhalb (links/rechts) = Letterboxing → Schwarz
         if (destX >= offsetX && destX < (offsetX + displayImageWidth))
         {
             //Inverse Mapping: destX → srcX (Position im Originalbild)
-            // (destX - offsetX) ist die Koordinate relativ zum Bildstart links
             float srcX_float = (float)(destX - offsetX) / scale;
-           
+
             int srcX_start = (int)floorf(srcX_float);
-           
+
             //Box-Breite
             int boxWidth = (int)ceilf(1.0f / scale);
             if (boxWidth < 1) boxWidth = 1;
- 
+
             int srcX_end = srcX_start + boxWidth;
- 
+
             //Gültige Grenzen sicherstellen
             if (srcX_end > srcW) srcX_end = srcW;
             if (srcX_start >= srcW) srcX_start = srcW - 1;
             if (srcX_start < 0) srcX_start = 0;
- 
-            // Box-Averaging, Wir mitteln RGB über alle Pixel im Box-Bereich
+
             uint32_t rSum = 0;
             uint32_t gSum = 0;
             uint32_t bSum = 0;
             int pixelCount = 0;
- 
+
             for (int r = 0; r < rowCount; r++)
             {
                 uint8_t *currentRow = inputRows[r];
-                // Falls Pointer ungültig ist, überspringen
                 if (!currentRow) continue;
- 
+
                 for (int sx = srcX_start; sx < srcX_end; sx++)
                 {
-                    uint8_t idx = currentRow[sx];
-                    RGBQUAD c = pal[idx];
-                   
+                    RGBQUAD c = pal[currentRow[sx]];
+
                     rSum += c.rgbRed;
                     gSum += c.rgbGreen;
                     bSum += c.rgbBlue;
                     pixelCount++;
                 }
             }
- 
-            //Mittelwert berechnen → Anti-Aliasing
+
             if (pixelCount > 0)
             {
                 RGBQUAD avg;
@@ -63,18 +955,18 @@ void scale_line_box_fit(uint16_t *outBuf, uint8_t **inputRows, int rowCount,
                 avg.rgbGreen = (uint8_t)(gSum / pixelCount);
                 avg.rgbBlue  = (uint8_t)(bSum / pixelCount);
                 avg.rgbReserved = 0;
- 
-                outBuf[destX] = rgb_to_16(avg); //16-Bit Format fürs Display
+
+                outBuf[destX] = rgb_to_16(avg);
             }
             else
             {
-                outBuf[destX] = 0; // Schwarz
+                outBuf[destX] = 0;
             }
         }
         else
         {
-            //Außerhalb des Bildes -> Schwarz (Letterboxing Balken)
             outBuf[destX] = 0;
         }
     }
-}
\ No newline at end of file
+}
+#endif
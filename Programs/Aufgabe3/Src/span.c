@@ -0,0 +1,70 @@
+#include "span.h"
+#include <string.h>
+
+void span_row_reset(SpanRow *row, int width)
+{
+    row->count = 0;
+    row->width = width;
+}
+
+//Literal-Bereich [x, x+len) anhängen oder mit dem vorherigen Literal-Span verschmelzen
+static void append_literal(SpanRow *row, int x, int len)
+{
+    if (row->count > 0)
+    {
+        RowSpan *last = &row->spans[row->count - 1];
+        if (last->color == SPAN_LITERAL && last->x + last->len == x)
+        {
+            last->len += (uint16_t)len;
+            return;
+        }
+    }
+
+    //Der letzte Platz ist immer für einen Literal-Span frei (siehe span_put_run)
+    RowSpan *s = &row->spans[row->count++];
+    s->x     = (uint16_t)x;
+    s->len   = (uint16_t)len;
+    s->color = SPAN_LITERAL;
+}
+
+void span_put_run(SpanRow *row, int x, int len, uint8_t color)
+{
+    if (x >= row->width || len <= 0)
+        return;
+    if (x + len > row->width)
+        len = row->width - x;
+
+    //Lange Läufe als eigener Span, solange noch Platz ist
+    if (len >= SPAN_MIN_RUN && row->count < SPAN_MAX_PER_ROW - 1)
+    {
+        RowSpan *s = &row->spans[row->count++];
+        s->x     = (uint16_t)x;
+        s->len   = (uint16_t)len;
+        s->color = color;
+        return;
+    }
+
+    memset(row->literal + x, color, (size_t)len);
+    append_literal(row, x, len);
+}
+
+void span_put_literal(SpanRow *row, int x, const uint8_t *src, int n)
+{
+    if (x >= row->width || n <= 0)
+        return;
+    if (x + n > row->width)
+        n = row->width - x;
+
+    memcpy(row->literal + x, src, (size_t)n);
+    append_literal(row, x, n);
+}
+
+void span_row_expand(SpanRow *row)
+{
+    for (int i = 0; i < row->count; i++)
+    {
+        const RowSpan *s = &row->spans[i];
+        if (s->color != SPAN_LITERAL)
+            memset(row->literal + s->x, (uint8_t)s->color, s->len);
+    }
+}
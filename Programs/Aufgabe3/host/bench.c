@@ -0,0 +1,225 @@
+/*
+ * Durchsatz-Messung der Dekodier-/Skalier-Pipeline auf dem Host.
+ *
+ * Gezeichnet wird mit derselben Schleife wie auf dem Board (render.c: Ringpuffer,
+ * Box-Filter, Hochskalieren, Spalten-Akkumulatoren für breite Bilder), in den
+ * Framebuffer aus host_io.h. Die Zeiten kommen aus den Stufenwechseln von render_image.
+ * Pro Bild: dekodierte MB/s (Dateibytes / Zeit in bmp_read_row_*),
+ * skalierte Zeilen/s (Ausgabezeilen / Zeit im Scaler) und Prüfsumme des Framebuffers.
+ * Breite Bilder (Streaming) dekodieren und skalieren verschränkt: statt MB/s steht "-",
+ * die Zeilen/s beziehen sich auf beide Stufen zusammen, die Summe der MB/s lässt sie aus.
+ * Mit -k läuft der Bild-Cache wie auf dem Board mit: ab der zweiten Wiederholung
+ * wird aus dem Cache gezeichnet (zählt als Skalierzeit), die Prüfsumme muss gleich bleiben.
+ * Mit -g kommen unkomprimierte Bilder in zwei Durchläufen (Grobdurchlauf per Sprung, render.h),
+ * die Prüfsumme muss gleich bleiben, die MB/s enthalten die zusätzlich gelesenen Zeilen.
+ *
+ * Aufruf: bmp_bench [-r Wiederholungen] [-c Chunkgröße] [-o PPM-Verzeichnis] [-k] [-g] Datei...
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_io.h"
+#include "LCD_GUI.h"
+#include "input.h"
+#include "headers.h"
+#include "bmp_reader.h"
+#include "lcd_output.h"
+#include "render.h"
+#include "errorhandler.h"
+
+typedef struct {
+    int width;
+    int height;
+    int bitCount;
+    bool streamed;    // Dekodieren und Falten verschränkt → nur die Summe ist aussagekräftig
+    double decodeSec; // Zeit in bmp_start + bmp_read_row_* (PIPE_HEADER, PIPE_DECODE)
+    double scaleSec;  // Zeit in den Scaler-Kerneln (PIPE_SCALE), bei Cache-Treffern das Zeichnen aus dem Cache
+    int outRows;      // ausgegebene LCD-Zeilen
+} RunStats;
+
+static double stageSec[PIPE_STAGES];
+static PipeStage currentStage = PIPE_OTHER;
+static double stageStart = 0.0;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+//Zeitmessung statt DWT-Zähler (pipe_stats.c): Stufenwechsel aus render_image aufsummieren
+static PipeStage switch_stage(PipeStage stage)
+{
+    double t = now_sec();
+    PipeStage prev = currentStage;
+    stageSec[prev] += t - stageStart;
+    stageStart = t;
+    currentStage = stage;
+    return prev;
+}
+
+//Ein Bild wie auf dem Board (render.c) dekodieren, skalieren und in den Framebuffer zeichnen
+static int render_run(const RenderConfig *cfg, RunStats *st)
+{
+    RenderResult res;
+
+    memset(st, 0, sizeof(*st));
+    memset(stageSec, 0, sizeof(stageSec));
+    openNextFile();
+    GUI_clear(BLACK);
+
+    currentStage = PIPE_OTHER;
+    stageStart = now_sec();
+    int status = render_image(cfg, &res);
+    switch_stage(PIPE_OTHER);
+
+    st->width = res.srcW;
+    st->height = res.srcH;
+    st->bitCount = res.bitCount;
+    st->streamed = res.streamed;
+    st->decodeSec = stageSec[PIPE_HEADER] + stageSec[PIPE_DECODE];
+    st->scaleSec = stageSec[PIPE_SCALE];
+    if (res.cacheHit)
+        st->scaleSec += stageSec[PIPE_LCD];
+    st->outRows = res.outRows;
+    return status;
+}
+
+static const char *base_name(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return (slash != NULL) ? slash + 1 : path;
+}
+
+int main(int argc, char **argv)
+{
+    int repeats = 5;
+    const char *ppmDir = NULL;
+    int firstFile = 1;
+    RenderConfig cfg = {
+        .upscale   = true,
+        .useCache  = false,
+        .readToEnd = true, //restliche Zeilen zählen zur Dekodierzeit
+        .stage     = switch_stage,
+    };
+
+    for (; firstFile < argc && argv[firstFile][0] == '-'; firstFile++)
+    {
+        const char *opt = argv[firstFile];
+        if (0 == strcmp(opt, "-k")) {
+            cfg.useCache = true;
+            continue;
+        }
+        if (0 == strcmp(opt, "-g")) {
+            cfg.coarsePass = true;
+            continue;
+        }
+        if (firstFile + 1 >= argc) {
+            fprintf(stderr, "Option %s braucht einen Wert\n", opt);
+            return 2;
+        }
+        if (0 == strcmp(opt, "-r")) {
+            repeats = atoi(argv[++firstFile]);
+            if (repeats < 1) repeats = 1;
+        } else if (0 == strcmp(opt, "-c")) {
+            host_input_set_chunk(atoi(argv[++firstFile]));
+        } else if (0 == strcmp(opt, "-o")) {
+            ppmDir = argv[++firstFile];
+        } else {
+            fprintf(stderr, "Unbekannte Option %s\n", opt);
+            return 2;
+        }
+    }
+    if (firstFile >= argc) {
+        fprintf(stderr, "Aufruf: %s [-r Wiederholungen] [-c Chunkgröße] [-o PPM-Verzeichnis] [-k] [-g] Datei...\n", argv[0]);
+        return 2;
+    }
+
+    initInput();
+    GUI_init(DEFAULT_BRIGHTNESS);
+
+    printf("%-32s %10s %3s %9s %9s %11s %10s\n",
+           "Datei", "BxH", "bpp", "Bytes", "Dek MB/s", "Skal Z/s", "Pruefsumme");
+
+    int failed = 0;
+    double totalBytes = 0.0, totalScale = 0.0;
+    double decodeBytes = 0.0, totalDecode = 0.0; //ohne Streaming-Bilder
+    long totalRows = 0;
+
+    for (int f = firstFile; f < argc; f++)
+    {
+        if (host_input_load(argv[f]) != EOK) {
+            printf("%-32s kann nicht gelesen werden\n", base_name(argv[f]));
+            failed++;
+            continue;
+        }
+
+        //Bester Lauf zählt (am wenigsten gestört), Prüfsumme muss in jedem Lauf gleich sein
+        RunStats best = {0};
+        uint32_t checksum = 0;
+        int ok = 1;
+        for (int rep = 0; rep < repeats && ok; rep++)
+        {
+            RunStats st;
+            if (render_run(&cfg, &st) != EOK) {
+                printf("%-32s Fehler: %s\n", base_name(argv[f]), host_last_text());
+                ok = 0;
+                break;
+            }
+            uint32_t sum = host_fb_checksum();
+            if (rep > 0 && sum != checksum) {
+                printf("%-32s Prüfsumme nicht stabil\n", base_name(argv[f]));
+                ok = 0;
+                break;
+            }
+            checksum = sum;
+            if (rep == 0 || st.decodeSec + st.scaleSec < best.decodeSec + best.scaleSec)
+                best = st;
+        }
+        if (!ok) {
+            failed++;
+            continue;
+        }
+
+        double bytes = (double)host_input_size();
+        char size[24];
+        char decode[16];
+        snprintf(size, sizeof(size), "%dx%d", best.width, best.height);
+        //Streaming: Dekodieren und Falten sind verschränkt → kein Dekodier-Durchsatz, Zeilen/s über beides
+        double scaleSec = best.scaleSec;
+        if (best.streamed) {
+            snprintf(decode, sizeof(decode), "-");
+            scaleSec += best.decodeSec;
+        } else {
+            snprintf(decode, sizeof(decode), "%.1f",
+                     (best.decodeSec > 0.0) ? bytes / best.decodeSec / 1e6 : 0.0);
+            decodeBytes += bytes;
+            totalDecode += best.decodeSec;
+        }
+        printf("%-32s %10s %3d %9.0f %9s %11.0f   %08x\n",
+               base_name(argv[f]), size, best.bitCount, bytes, decode,
+               (scaleSec > 0.0) ? best.outRows / scaleSec : 0.0,
+               (unsigned)checksum);
+
+        totalBytes  += bytes;
+        totalScale  += scaleSec;
+        totalRows   += best.outRows;
+
+        if (ppmDir != NULL) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s.ppm", ppmDir, base_name(argv[f]));
+            if (host_fb_write_ppm(path) != EOK)
+                fprintf(stderr, "%s konnte nicht geschrieben werden\n", path);
+        }
+    }
+
+    printf("%-32s %10s %3s %9.0f %9.1f %11.0f\n", "Summe", "", "", totalBytes,
+           (totalDecode > 0.0) ? decodeBytes / totalDecode / 1e6 : 0.0,
+           (totalScale > 0.0) ? totalRows / totalScale : 0.0);
+
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+"""
+Verkleinert BMP-Dateien auf dem PC, bevor bmp_sender.py sie schickt (Panel-Abfrage 'V' in Src/input.c).
+
+fit(data, breite, höhe, format) liest die Formate, die auch das Board kennt (24 Bit unkomprimiert,
+1/4/8 Bit mit Palette, RLE8, RLE4), mittelt jede Box aus Quellpixeln zu einem Zielpixel (wie der
+Box-Filter in scaler.c, Seitenverhältnis bleibt) und schreibt das Ergebnis im gewünschten Format:
+'P' = 8 Bit Palette als RLE8, 'T' = 24 Bit unkomprimiert. Für RLE8 werden die Farben auf höchstens
+256 reduziert: genau, wenn es nicht mehr gibt, sonst Median-Cut über 15-Bit-Farben. Das ist verlustbehaftet,
+deshalb bleiben bei 'P' zwei Fälle 24 Bit: Quellen mit 24 Bit und mehr als 256 Farben (Verläufe in Fotos
+bekämen Stufen) und Bilder, deren Palette im Mittel mehr als MAX_QUANT_RMS vom Original abweicht.
+Wird die Datei dabei nicht kleiner (z.B. RLE4 knapp über Panelgröße), bleibt es beim Original.
+Ohne Python-Erweiterungen (kein PIL): die Arbeit pro Pixel steckt in bytes.translate, map und sum.
+"""
+import heapq
+from collections import Counter
+from operator import add, mul, sub
+
+BI_RGB, BI_RLE8, BI_RLE4 = 0, 1, 2
+FORMAT_RLE8, FORMAT_RGB24 = 'P', 'T'  # PANEL_FORMAT_* in input.c
+FILE_HEADER_SIZE, INFO_HEADER_SIZE = 14, 40
+MAX_QUANT_RMS = 4.0  # mittlerer Fehler der Palette je Kanal, darüber 24 Bit (eine RGB565-Stufe Grün)
+
+
+def _u16(data, pos):
+    return int.from_bytes(data[pos:pos + 2], 'little')
+
+
+def _u32(data, pos):
+    return int.from_bytes(data[pos:pos + 4], 'little', signed=True)
+
+
+def _rle_rows(data, w, h, four):
+    """RLE8/RLE4 → Indexzeilen (von unten), Lücken (Delta, Zeilenende, Bildende) mit Index 0 wie SPAN_BACKGROUND."""
+    rows = [bytearray(w) for _ in range(h)]
+    x = y = 0
+    pos = 0
+    end = len(data)
+    while pos + 1 < end and y < h:
+        n, v = data[pos], data[pos + 1]
+        pos += 2
+        if n:
+            if four:
+                pair = bytes([v >> 4, v & 15])
+                run = (pair * ((n + 1) // 2))[:n]
+            else:
+                run = bytes([v]) * n
+            run = run[:max(0, w - x)]
+            rows[y][x:x + len(run)] = run
+            x += n
+        elif v == 0:
+            x, y = 0, y + 1
+        elif v == 1:
+            break
+        elif v == 2:
+            if pos + 1 >= end:
+                break
+            x, y = x + data[pos], y + data[pos + 1]
+            pos += 2
+        else:
+            size = (v + 1) // 2 if four else v
+            lit = data[pos:pos + size]
+            pos += (size + 1) & ~1
+            if four:
+                packed = bytearray(2 * len(lit))
+                packed[0::2] = lit.translate(_HI_NIBBLE)
+                packed[1::2] = lit.translate(_LO_NIBBLE)
+                lit = packed[:v]
+            lit = lit[:max(0, w - x)]
+            rows[y][x:x + len(lit)] = lit
+            x += v
+    return rows
+
+
+_HI_NIBBLE = bytes(i >> 4 for i in range(256))
+_LO_NIBBLE = bytes(i & 15 for i in range(256))
+_BITS = [bytes((i >> (7 - k)) & 1 for i in range(256)) for k in range(8)]
+
+
+def _packed_rows(data, w, h, bits):
+    """Ungepackte 1/4/8-Bit-Zeilen (auf 32 Bit aufgefüllt) → Indexzeilen (von unten)."""
+    stride = (w * bits + 31) // 32 * 4
+    rows = []
+    for y in range(h):
+        row = data[y * stride:(y + 1) * stride].ljust(stride, b'\0')
+        if bits == 8:
+            rows.append(row[:w])
+            continue
+        per = 8 // bits
+        tables = (_HI_NIBBLE, _LO_NIBBLE) if bits == 4 else _BITS
+        out = bytearray(per * stride)
+        for k in range(per):
+            out[k::per] = row.translate(tables[k])
+        rows.append(bytes(out[:w]))
+    return rows
+
+
+def _channels(data):
+    """Liefert (Breite, Höhe, Zeilen, Bits pro Pixel) mit Zeilen von unten als (B, G, R)-bytes,
+    None bei unbekanntem Format."""
+    if len(data) < FILE_HEADER_SIZE + INFO_HEADER_SIZE or data[:2] != b'BM':
+        return None
+    off_bits = _u32(data, 10)
+    info_size = _u32(data, 14)
+    w, h = _u32(data, 18), _u32(data, 22)
+    bits, compression = _u16(data, 28), _u32(data, 30)
+    colors = _u32(data, 46)
+    if w < 1 or h < 1 or info_size < INFO_HEADER_SIZE:
+        return None
+    pixels = data[off_bits:]
+
+    if bits == 24 and compression == BI_RGB:
+        stride = (w * 3 + 3) & ~3
+        rows = []
+        for y in range(h):
+            row = pixels[y * stride:y * stride + 3 * w].ljust(3 * w, b'\0')
+            rows.append((row[0::3], row[1::3], row[2::3]))
+        return w, h, rows, bits
+
+    if bits not in (1, 4, 8):
+        return None
+    if compression == BI_RLE8 and bits == 8:
+        index_rows = _rle_rows(pixels, w, h, False)
+    elif compression == BI_RLE4 and bits == 4:
+        index_rows = _rle_rows(pixels, w, h, True)
+    elif compression == BI_RGB:
+        index_rows = _packed_rows(pixels, w, h, bits)
+    else:
+        return None
+
+    count = colors if 0 < colors <= (1 << bits) else (1 << bits)
+    table = data[FILE_HEADER_SIZE + info_size:FILE_HEADER_SIZE + info_size + 4 * count].ljust(1024, b'\0')
+    tables = [table[c::4][:256] for c in range(3)]  # B, G, R je Index
+    rows = [tuple(bytes(row).translate(t) for t in tables) for row in index_rows]
+    return w, h, rows, bits
+
+
+def _bounds(src, dst):
+    """Quellbereich [a, b) jedes Zielpixels, mindestens ein Quellpixel."""
+    return [(i * src // dst, (i + 1) * src // dst) for i in range(dst)]
+
+
+def _box_filter(w, h, rows, dw, dh):
+    """Mittelwert jeder Box → Zeilen (von unten) als (B, G, R)-bytes der Breite dw."""
+    cols = _bounds(w, dw)
+    out = []
+    for y0, y1 in _bounds(h, dh):
+        acc = [[0] * w for _ in range(3)]
+        for y in range(y0, y1):
+            for c in range(3):
+                acc[c] = list(map(add, acc[c], rows[y][c]))
+        n = y1 - y0
+        line = []
+        for c in range(3):
+            a = acc[c]
+            line.append(bytes((sum(a[x0:x1]) + (x1 - x0) * n // 2) // ((x1 - x0) * n) for x0, x1 in cols))
+        out.append(tuple(line))
+    return out
+
+
+def _median_cut(hist, colors):
+    """15-Bit-Farben mit Häufigkeit → Liste von Boxen (je Liste von Farben), immer die größte zuerst geteilt."""
+    order = [0]  # gleiche Gewichte in fester Reihenfolge → gleiche Palette bei jedem Lauf
+
+    def entry(items):
+        order[0] += 1
+        ranges = []
+        for shift in (10, 5, 0):
+            values = [(k >> shift) & 31 for k, _ in items]
+            ranges.append(max(values) - min(values))
+        channel = ranges.index(max(ranges))
+        weight = max(ranges) * sum(c for _, c in items)
+        return (-weight, order[0], items, (10, 5, 0)[channel])
+
+    heap = [entry(list(hist.items()))]
+    done = []
+    while heap and len(heap) + len(done) < colors:
+        weight, _, items, shift = heapq.heappop(heap)
+        if weight == 0:
+            done.append(items)
+            continue
+        items.sort(key=lambda kc: (kc[0] >> shift) & 31)
+        half = sum(c for _, c in items) / 2.0
+        seen = 0
+        cut = 1
+        for i, (_, c) in enumerate(items[:-1]):
+            seen += c
+            cut = i + 1
+            if seen >= half:
+                break
+        heapq.heappush(heap, entry(items[:cut]))
+        heapq.heappush(heap, entry(items[cut:]))
+    return done + [e[2] for e in heap]
+
+
+def _rms_error(rows, palette, indices):
+    """Mittlere Abweichung je Kanal zwischen den Zeilen und ihren Palettenfarben."""
+    tables = [palette[c::4].ljust(256, b'\0') for c in range(3)]
+    err = n = 0
+    for row, idx in zip(rows, indices):
+        for c in range(3):
+            d = list(map(sub, row[c], idx.translate(tables[c])))
+            err += sum(map(mul, d, d))
+        n += 3 * len(idx)
+    return (err / n) ** 0.5 if n else 0.0
+
+
+def _quantize(rows, lossy):
+    """Zeilen aus (B, G, R)-bytes → (Palette als BGRA-bytes, Indexzeilen).
+    None, wenn es mehr als 256 Farben gibt und lossy falsch ist oder der Median-Cut zu grob wird."""
+    keys = [[(r << 16) | (g << 8) | b for b, g, r in zip(*row)] for row in rows]
+    exact = Counter()
+    for row in keys:
+        exact.update(row)
+    if len(exact) <= 256:
+        palette = sorted(exact)
+        lut = {k: i for i, k in enumerate(palette)}
+        indices = [bytes(map(lut.__getitem__, row)) for row in keys]
+        return b''.join(bytes([k & 255, (k >> 8) & 255, k >> 16, 0]) for k in palette), indices
+    if not lossy:
+        return None
+
+    def key15(k):
+        return ((k >> 19) << 10) | (((k >> 11) & 31) << 5) | ((k >> 3) & 31)
+
+    short = [list(map(key15, row)) for row in keys]
+    hist = Counter()
+    for row in short:
+        hist.update(row)
+    lut = [0] * 32768
+    for i, box in enumerate(_median_cut(hist, 256)):
+        for k, _ in box:
+            lut[k] = i
+    indices = [bytes(map(lut.__getitem__, row)) for row in short]
+
+    # Palettenfarbe = Mittel der echten Farben, die auf den Index fallen
+    sums = [[0, 0, 0, 0] for _ in range(256)]
+    for row, idx in zip(keys, indices):
+        for k, i in zip(row, idx):
+            s = sums[i]
+            s[0] += k & 255
+            s[1] += (k >> 8) & 255
+            s[2] += k >> 16
+            s[3] += 1
+    palette = b''.join(bytes([(s[0] + s[3] // 2) // s[3], (s[1] + s[3] // 2) // s[3],
+                              (s[2] + s[3] // 2) // s[3], 0]) if s[3] else bytes(4) for s in sums)
+    if _rms_error(rows, palette, indices) > MAX_QUANT_RMS:
+        return None
+    return palette, indices
+
+
+def _encode_rle8_row(row):
+    """Läufe ab 3 Pixeln kodiert, sonst Absolute Mode (ab 3 Bytes, auf 16 Bit aufgefüllt), wie gen_corpus.c."""
+    out = bytearray()
+    w = len(row)
+    x = 0
+    while x < w:
+        run = 1
+        while x + run < w and run < 255 and row[x + run] == row[x]:
+            run += 1
+        if run >= 3:
+            out += bytes([run, row[x]])
+            x += run
+            continue
+        lit = 0
+        while x + lit < w and lit < 255:
+            p = x + lit
+            if p + 2 < w and row[p] == row[p + 1] == row[p + 2]:
+                break
+            lit += 1
+        if lit < 3:
+            for i in range(lit):
+                out += bytes([1, row[x + i]])
+        else:
+            out += bytes([0, lit]) + row[x:x + lit]
+            if lit & 1:
+                out.append(0)
+        x += lit
+    out += b'\0\0'  # End Of Line
+    return out
+
+
+def _bmp(w, h, bits, compression, palette, pixels):
+    off_bits = FILE_HEADER_SIZE + INFO_HEADER_SIZE + len(palette)
+    head = b'BM' + (off_bits + len(pixels)).to_bytes(4, 'little') + bytes(4) + off_bits.to_bytes(4, 'little')
+    info = b''.join(v.to_bytes(n, 'little') for v, n in (
+        (INFO_HEADER_SIZE, 4), (w, 4), (h, 4), (1, 2), (bits, 2), (compression, 4), (len(pixels), 4),
+        (2835, 4), (2835, 4), (len(palette) // 4, 4), (0, 4)))
+    return head + info + palette + pixels
+
+
+def _encode(small, dw, dh, fmt, true_colour):
+    if fmt == FORMAT_RLE8:
+        quantized = _quantize(small, not true_colour)
+        if quantized is not None:
+            palette, indices = quantized
+            pixels = b''.join(_encode_rle8_row(row) for row in indices) + b'\0\1'  # End Of Bitmap
+            return _bmp(dw, dh, 8, BI_RLE8, palette, pixels)
+        fmt = FORMAT_RGB24  # Palette würde sichtbar verlieren
+    if fmt == FORMAT_RGB24:
+        pad = bytes((-3 * dw) & 3)
+        lines = []
+        for b, g, r in small:
+            line = bytearray(3 * dw)
+            line[0::3], line[1::3], line[2::3] = b, g, r
+            lines.append(bytes(line) + pad)
+        return _bmp(dw, dh, 24, BI_RGB, b'', b''.join(lines))
+    return None
+
+
+def fit(data, width, height, fmt):
+    """Verkleinerte BMP-Datei, None wenn das Bild schon passt, nicht kleiner wird oder das Format unbekannt ist."""
+    image = _channels(data)
+    if image is None:
+        return None
+    w, h, rows, bits = image
+    scale = min(width / w, height / h)
+    if scale >= 1.0:
+        return None  # passt schon, mehr Bytes würden es nur durch Hochskalieren
+    dw, dh = max(1, int(w * scale)), max(1, int(h * scale))
+    fitted = _encode(_box_filter(w, h, rows, dw, dh), dw, dh, fmt, bits == 24)
+    return fitted if fitted is not None and len(fitted) < len(data) else None
@@ -0,0 +1,486 @@
+#!/usr/bin/env python3
+"""
+Referenz-Sender für das Übertragungsprotokoll von Aufgabe3 (Src/input.c).
+
+Handshake: 'H' bis das Board mit 'R' antwortet, dann noch ein 'H'. Nur ein neues Board antwortet
+darauf wieder mit 'R' (ein altes überliest weitere 'H' stillschweigend), erst dann folgen die
+Angebote: das Fenster 'X' + 4 Hex-Ziffern Burstgröße + 2 Hex-Ziffern Fenster. Antwortet das Board
+mit 'A' + angenommenen Werten, gilt das Fenster-Protokoll, sonst das alte. Ohne zweites 'R' (altes
+Board) bleibt es ohne Angebot beim alten Protokoll. Zum Schluss 'G'.
+
+Altes Protokoll:   'S' → nächste Datei, erster Burst; 'D' → nächster Burst.
+                   Burst = Länge (2 Byte, Big Endian) + Daten, Länge 0 = Dateiende.
+Fenster-Protokoll: 'S' → nächste Datei, bis zu <Fenster> Bursts sofort;
+                   jedes 'D' erlaubt einen weiteren Burst.
+                   Burst = Folgenummer (1 Byte, ab 0 pro Datei) + Länge (2 Byte) + Daten.
+Zwischen zwei Dateien kann das Board 'T' + Textzeile + '\n' senden (PIPE_STATS), sie wird ausgegeben.
+
+Nach angenommenem Fenster (vor 'G'):
+CRC:      'C' → Board 'K': jeder Burst trägt nach der Länge eine CRC32 der Daten (4 Byte, Big Endian),
+          wie die CRC-Einheit des STM32 sie rechnet. Das Board antwortet auf einen defekten Burst
+          mit 'E' + Folgenummer (2 Hex-Ziffern), ab diesem Burst wird neu gesendet (Go-Back-N).
+Baudrate: 'B' + 8 Hex-Ziffern → Board 'K' (schaltet um) oder 'N' (nicht einstellbar).
+          Nach 'K' auf die neue Rate umschalten und 'P' + Prüfmuster senden; 'K' auf der neuen Rate
+          bestätigt, sonst zurückschalten und auf 'N' warten. Stufenweise bis --max-baud.
+Sprung:   'O' → Board 'K': das Board darf 'O' + Position (8 Hex-Ziffern) + Länge (8 Hex-Ziffern)
+          senden, der Bereich der aktuellen Datei kommt dann wie eine neue Datei (Folgenummer ab 0,
+          ganzes Fenster, leerer Burst am Bereichsende). Für Pan/Zoom auf dem Board.
+Liste:    'L' + Anzahl Dateien (4 Hex-Ziffern) → Board 'K': das Board darf 'F' + Index (4 Hex-Ziffern)
+          senden, das nächste 'S' schickt dann diese Datei (danach geht es in der Liste weiter), und
+          'Y' + erste Datei (4 Hex-Ziffern) + Anzahl (2 Hex-Ziffern): die ersten 54 Bytes (BMP-Datei-
+          und Info-Header) dieser Dateien hintereinander, kürzere mit 0 aufgefüllt, wie eine Datei.
+          Für den Kontaktabzug auf dem Board.
+Abbruch:  'Z' → Board 'K': das Board darf 'Z' senden, die aktuelle Datei (oder der Bereich) endet dann
+          sofort. Hinter den Bursts, die schon unterwegs sind, folgt ein Burst-Kopf mit Länge 0xFFFF
+          ohne Daten, bis dorthin verwirft das Board alles. Für abgelehnte und nicht mehr gebrauchte Dateien.
+Stichprobe: 'Q' → Board 'K': das Board darf 'Q' + Position (8 Hex-Ziffern) + Zeilenlänge (8) + Pixelgröße (1)
+          + Quellbreite (4) + Breite (4) + Anzahl (2) + Anzahl Zeilennummern (je 4 Hex-Ziffern) senden.
+          Von jeder Zeile r kommen die Pixel x = (2 j + 1) * Quellbreite / (2 * Breite), j < Breite, zu je
+          Pixelgröße Bytes ab Position + r * Zeilenlänge + x * Pixelgröße, bei Pixelgröße 0 die ganzen Zeilen,
+          alles hintereinander wie ein Bereich von 'O'. Für die Vorschaubilder des Kontaktabzugs.
+
+Nach dem Fenster-Angebot (auch wenn das Board es ablehnt, nicht bei einem alten Board):
+Panel:    'V' → Board 'V' + Breite (4 Hex-Ziffern) + Höhe (4 Hex-Ziffern) + Format ('P' = 8 Bit Palette
+          als RLE8, 'T' = 24 Bit) oder 'N'. Größere Bilder werden dann hier passend verkleinert und im
+          Format des Boards gesendet (bmp_fit.py), auch für 'Y' und 'O'. 'P' ist verlustbehaftet, Fotos
+          und zu grobe Paletten gehen deshalb als 'T'. Ohne Antwort die Originaldateien.
+
+Aufruf: bmp_sender.py [--burst N] [--window N] [--legacy] [--no-crc] [--no-fit] [--baud B] [--max-baud B] [--cycle]
+                      PORT DATEI...
+PORT ist eine serielle Schnittstelle oder der Pfad, den uart_loopback ausgibt.
+"""
+import argparse
+import os
+import select
+import sys
+import time
+
+import bmp_fit
+
+HELLO, READY, GO = b'H', b'R', b'G'
+START, DATA = b'S', b'D'
+WINDOW, ACCEPT = b'X', b'A'
+TEXT = b'T'
+CRC, BAUD, PROBE = b'C', b'B', b'P'
+SEEK = b'O'
+SAMPLE = b'Q'
+LIST, FILE, HEADERS = b'L', b'F', b'Y'
+ABORT = b'Z'
+ABORT_MARK = 0xFFFF  # ABORT_MARK in input.c
+PANEL = b'V'
+HEADERS_SIZE = 54  # HEADERS_SIZE in input.h
+OK, NAK, RETRY = b'K', b'N', b'E'
+LEGACY_BURST = 512
+DEFAULT_BAUD = 115200
+BAUD_RATES = (230400, 460800, 921600, 1000000, 1500000, 2000000, 2500000, 3000000)
+PROBE_PATTERN = bytes(((i * 0x3B) ^ 0x55) & 0xFF for i in range(64))  # PROBE_SIZE in input.c
+PROBE_TIMEOUT = 0.25  # länger als PROBE_TIMEOUT_MS in input.c: das Board antwortet vorher
+
+
+def _crc_table():
+    table = []
+    for i in range(256):
+        c = i << 24
+        for _ in range(8):
+            c = ((c << 1) ^ 0x04C11DB7) if c & 0x80000000 else (c << 1)
+        table.append(c & 0xFFFFFFFF)
+    return table
+
+
+CRC_TABLE = _crc_table()
+
+
+def stm32_crc(data):
+    """CRC der STM32-CRC-Einheit: 32-Bit-Worte Little Endian, MSB zuerst, letztes Wort mit 0 aufgefüllt."""
+    data = bytes(data) + bytes(-len(data) % 4)
+    swapped = bytearray(len(data))
+    for k in range(4):
+        swapped[k::4] = data[3 - k::4]
+    crc = 0xFFFFFFFF
+    for b in swapped:
+        crc = ((crc << 8) & 0xFFFFFFFF) ^ CRC_TABLE[(crc >> 24) ^ b]
+    return crc
+
+
+class Port:
+    """Serielle Schnittstelle: pyserial, falls vorhanden, sonst POSIX-Terminal (auch Pseudo-Terminals)."""
+
+    def __init__(self, path, baud):
+        self.ser = None
+        self.fd = None
+        try:
+            import serial
+            self.ser = serial.Serial(path, baudrate=baud or 115200, timeout=None)
+            return
+        except ImportError:
+            pass
+        import termios
+        import tty
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        if baud:
+            self.set_baud(baud)
+
+    def set_baud(self, baud):
+        """Umschalten, nachdem alle geschriebenen Bytes raus sind."""
+        if self.ser is not None:
+            self.ser.flush()
+            self.ser.baudrate = baud
+            return
+        import termios
+        termios.tcdrain(self.fd)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[4] = attrs[5] = getattr(termios, 'B%d' % baud)
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+
+    def write(self, data):
+        if self.ser is not None:
+            self.ser.write(data)
+            return
+        view = memoryview(data)
+        while view:
+            n = os.write(self.fd, view)
+            view = view[n:]
+
+    def read(self, n, timeout=None):
+        """Bis zu n Bytes; b'' bei Timeout oder geschlossener Gegenseite."""
+        if self.ser is not None:
+            self.ser.timeout = timeout
+            return self.ser.read(n)
+        ready, _, _ = select.select([self.fd], [], [], timeout)
+        if not ready:
+            return b''
+        try:
+            return os.read(self.fd, n)
+        except OSError:
+            return b''  # EIO: uart_loopback beendet
+
+    def read_exact(self, n, timeout):
+        data = b''
+        deadline = time.monotonic() + timeout
+        while len(data) < n:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                break
+            chunk = self.read(n - len(data), left)
+            if not chunk:
+                break
+            data += chunk
+        return data
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def negotiate_baud(port, baud, max_baud):
+    """Stuft die Baudrate bis max_baud hoch, solange das Prüfmuster fehlerfrei ankommt; liefert die letzte gute."""
+    for offer in BAUD_RATES:
+        if offer <= baud or offer > max_baud:
+            continue
+        port.write(BAUD + b'%08X' % offer)
+        answer = port.read_exact(1, 0.5)
+        if answer == NAK:
+            continue  # Board kann die Rate nicht einstellen, nächste versuchen
+        if answer != OK:
+            break     # Board ohne Aushandlung
+        port.set_baud(offer)
+        time.sleep(0.02)
+        port.write(PROBE + PROBE_PATTERN)
+        if port.read_exact(1, PROBE_TIMEOUT) == OK:
+            baud = offer
+            continue
+        # Board schaltet nach seinem Timeout zurück und meldet NAK auf der alten Rate
+        port.set_baud(baud)
+        deadline = time.monotonic() + 2.0
+        while time.monotonic() < deadline and port.read(1, deadline - time.monotonic()) not in (NAK, b''):
+            pass
+        break
+    return baud
+
+
+def probe_board(port):
+    """Zweites 'H': nur ein neues Board antwortet mit 'R'. Danach weitere 'R' auf 'H' aus der
+    Warteschleife abholen, damit sie nicht als Antwort auf ein Angebot gelesen werden."""
+    port.write(HELLO)
+    if port.read(1, 0.25) != READY:
+        return False
+    while port.read(1, 0.05) == READY:
+        pass
+    return True
+
+
+def handshake(port, burst, window, legacy, crc, baud, max_baud, files, fit):
+    """Liefert (Burstgröße, Fenster, CRC, Baudrate, Sprung, Liste, Abbruch, Stichprobe, Panel); Fenster 0 = altes
+    Protokoll, Panel (Breite, Höhe, Format) oder None."""
+    while True:
+        port.write(HELLO)
+        if port.read(1, 0.2) == READY:
+            break
+
+    result = (LEGACY_BURST, 0, False, baud, False, False, False, False)
+    panel = None
+    if not legacy and probe_board(port):  # altes Board: kein Angebot, es kennt weder 'X' noch 'V'
+        port.write(WINDOW + b'%04X%02X' % (burst, window))
+        answer = port.read_exact(7, 0.5)
+        if len(answer) == 7 and answer[:1] == ACCEPT:
+            burst, window = int(answer[1:5], 16), int(answer[5:7], 16)
+            if crc:
+                port.write(CRC)
+                crc = port.read_exact(1, 0.5) == OK
+            port.write(SEEK)
+            seek = port.read_exact(1, 0.5) == OK
+            listing = False
+            if files <= 0xFFFF:
+                port.write(LIST + b'%04X' % files)
+                listing = port.read_exact(1, 0.5) == OK
+            port.write(ABORT)
+            abort = port.read_exact(1, 0.5) == OK
+            port.write(SAMPLE)
+            sample = port.read_exact(1, 0.5) == OK
+            if max_baud > baud:
+                baud = negotiate_baud(port, baud, max_baud)
+            result = (burst, window, crc, baud, seek, listing, abort, sample)
+        if fit:
+            port.write(PANEL)
+            if port.read_exact(1, 0.5) == PANEL:
+                answer = port.read_exact(9, 0.5)
+                if len(answer) == 9:
+                    panel = (int(answer[:4], 16), int(answer[4:8], 16), answer[8:].decode('latin-1'))
+    port.write(GO)
+    return result + (panel,)
+
+
+class Library:
+    """Dateien der Kommandozeile; mit Panel einmal verkleinert und dann aus dem Speicher."""
+
+    def __init__(self, paths, panel):
+        self.paths = paths
+        self.panel = panel
+        self.cache = {}
+
+    def __len__(self):
+        return len(self.paths)
+
+    def load(self, index):
+        """Liefert (Inhalt, Größe der Originaldatei oder 0, wenn unverändert)."""
+        if index not in self.cache:
+            with open(self.paths[index], 'rb') as f:
+                data = f.read()
+            fitted = bmp_fit.fit(data, *self.panel) if self.panel else None
+            self.cache[index] = (fitted, len(data)) if fitted is not None else (data, 0)
+        return self.cache[index]
+
+
+class Transfer:
+    """Sendezustand der aktuellen Datei."""
+
+    def __init__(self, port, burst, window, crc, path, data, original=0):
+        self.data = data
+        self.source = data  # was pump() sendet: die Datei oder die Pixel einer Stichprobe
+        self.original = original  # Größe vor dem Verkleinern, 0: Originaldatei
+        self.port = port
+        self.burst = burst
+        self.window = window
+        self.crc = crc
+        self.path = path
+        self.pos = 0
+        self.end = len(self.data)  # Ende der Datei oder des Bereichs nach seek()/sample()
+        self.seq = 0
+        self.starts = {}  # Folgenummer → Dateiposition, für Wiederholungen
+        self.retries = 0
+        self.seeks = 0
+        self.credits = window if window else 1
+        self.done = False
+        self.seconds = 0.0
+        self.start = time.monotonic()
+
+    def pump(self):
+        while self.credits > 0 and not self.done:
+            chunk = self.source[self.pos:min(self.pos + self.burst, self.end)]
+            header = len(chunk).to_bytes(2, 'big')
+            if self.crc:
+                header += stm32_crc(chunk).to_bytes(4, 'big')
+            if self.window:
+                self.starts[self.seq] = self.pos
+                header = bytes([self.seq]) + header
+            self.port.write(header + chunk)
+            self.pos += len(chunk)
+            self.seq = (self.seq + 1) & 0xFF
+            self.credits -= 1
+            if not chunk:
+                self.done = True
+                if not self.seeks:
+                    self.seconds = time.monotonic() - self.start
+
+    def retry(self, seq):
+        """Go-Back-N: ab Burst seq neu senden, das Board erlaubt wieder ein ganzes Fenster."""
+        if seq not in self.starts:
+            return
+        self.pos = self.starts[seq]
+        self.seq = seq
+        self.credits = self.window
+        self.done = False
+        self.retries += 1
+        self.pump()
+
+    def seek(self, offset, length):
+        """Bereich [offset, offset + length) wie eine neue Datei senden."""
+        self.source = self.data
+        self.pos = min(offset, len(self.data))
+        self.end = min(len(self.data), self.pos + length)
+        self.restart()
+
+    def sample(self, offset, stride, size, src_width, width, rows):
+        """Stichprobe der Zeilen rows (Spalten aus der Mitte jedes Abschnitts) wie einen Bereich senden."""
+        parts = []
+        for row in rows:
+            base = offset + row * stride
+            if size == 0:
+                parts.append(self.data[base:base + stride])
+                continue
+            for j in range(width):
+                x = base + (2 * j + 1) * src_width // (2 * width) * size
+                parts.append(self.data[x:x + size])
+        self.source = b''.join(parts)
+        self.pos = 0
+        self.end = len(self.source)
+        self.restart()
+
+    def restart(self):
+        """Folgenummern ab 0 und ein ganzes Fenster, wie bei einer neuen Datei."""
+        self.seq = 0
+        self.starts = {}
+        self.credits = self.window if self.window else 1
+        self.done = False
+        self.seeks += 1
+        self.pump()
+
+    def abort(self):
+        """Keine Bursts mehr, die Markierung folgt auf die schon gesendeten."""
+        self.done = True
+        self.credits = 0
+
+    def report(self):
+        print('%-40s %9d Bytes %9.1f KB/s  FNV %08x%s%s%s%s' % (
+            os.path.basename(self.path), len(self.data),
+            len(self.data) / self.seconds / 1024.0 if self.seconds > 0 else 0.0, fnv1a(self.data),
+            '  verkleinert von %d Bytes' % self.original if self.original else '',
+            '  %d Wiederholungen' % self.retries if self.retries else '',
+            '  %d Sprünge' % self.seeks if self.seeks else '',
+            '  abgebrochen bei %d Bytes' % self.pos if self.seconds == 0.0 else ''))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Sendet BMP-Dateien an Aufgabe3 (oder uart_loopback).')
+    ap.add_argument('--burst', type=int, default=2048, help='angebotene Burstgröße (Fenster-Protokoll)')
+    ap.add_argument('--window', type=int, default=4, help='angebotene Anzahl Bursts unterwegs')
+    ap.add_argument('--legacy', action='store_true', help='kein Angebot, altes Protokoll erzwingen')
+    ap.add_argument('--no-crc', action='store_true', help='Bursts ohne CRC32 senden')
+    ap.add_argument('--no-fit', action='store_true', help='Originaldateien senden, auch wenn das Board sein Panel meldet')
+    ap.add_argument('--baud', type=int, default=0, help='Baudrate der seriellen Schnittstelle')
+    ap.add_argument('--max-baud', type=int, default=0, help='Baudrate stufenweise bis hierhin aushandeln')
+    ap.add_argument('--cycle', action='store_true', help='nach der letzten Datei wieder von vorn')
+    ap.add_argument('port')
+    ap.add_argument('files', nargs='+')
+    args = ap.parse_args()
+
+    if not 1 <= args.burst <= 0xFFFF or not 1 <= args.window <= 0xFF:
+        ap.error('Burst 1..65535, Fenster 1..255')
+
+    port = Port(args.port, args.baud)
+    burst, window, crc, baud, seek, listing, abort, sample, panel = handshake(
+        port, args.burst, args.window, args.legacy, not args.no_crc, args.baud or DEFAULT_BAUD, args.max_baud,
+        len(args.files), not args.no_fit)
+    files = Library(args.files, panel)
+    if window:
+        print('Fenster-Protokoll: Burst %d Bytes, %d Bursts unterwegs' % (burst, window))
+    else:
+        print('Altes Protokoll: Burst %d Bytes' % burst)
+    print('Baudrate %d, %s%s%s%s%s%s' % (baud, 'CRC32 pro Burst' if crc else 'ohne CRC', ', Sprünge' if seek else '',
+                                         ', Dateiauswahl' if listing else '', ', Abbruch' if abort else '',
+                                         ', Stichproben' if sample else '',
+                                         ', verkleinert auf %dx%d (%s)' % panel if panel else ''))
+
+    # Bericht erst am Ende, damit die Prüfsumme nicht zwischen zwei Dateien Zeit kostet
+    index = 0
+    transfer = None
+    finished = []
+    while True:
+        if panel and (transfer is None or transfer.done):
+            files.load(index % len(files))  # nächste Datei verkleinern, während das Board noch zeichnet
+        cmd = port.read(1)
+        if not cmd:
+            break  # Gegenseite geschlossen
+        if cmd == START:
+            if index == len(args.files):
+                if not args.cycle:
+                    break
+                index = 0
+            if transfer is not None and transfer.path is not None:
+                finished.append(transfer)
+            transfer = Transfer(port, burst, window, crc, args.files[index], *files.load(index))
+            index += 1
+            transfer.pump()
+        elif cmd == TEXT:
+            line = b''
+            while not line.endswith(b'\n'):
+                c = port.read(1)
+                if not c:
+                    break
+                line += c
+            print('Board: ' + line.decode('latin-1').rstrip())
+        elif cmd == DATA:
+            if transfer is not None and not transfer.done:
+                transfer.credits += 1
+                transfer.pump()
+        elif cmd == RETRY:
+            seq = port.read_exact(2, 1.0)
+            if transfer is not None and len(seq) == 2:
+                transfer.retry(int(seq, 16))
+        elif cmd == SEEK:
+            request = port.read_exact(16, 1.0)
+            if transfer is not None and len(request) == 16:
+                transfer.seek(int(request[:8], 16), int(request[8:], 16))
+        elif cmd == SAMPLE:
+            request = port.read_exact(27, 1.0)
+            count = int(request[25:], 16) if len(request) == 27 else 0
+            rows = port.read_exact(4 * count, 1.0)
+            if transfer is not None and count and len(rows) == 4 * count:
+                transfer.sample(int(request[:8], 16), int(request[8:16], 16), int(request[16:17], 16),
+                                int(request[17:21], 16), int(request[21:25], 16),
+                                [int(rows[k:k + 4], 16) for k in range(0, len(rows), 4)])
+        elif cmd == ABORT:
+            seq = 0
+            if transfer is not None:
+                transfer.abort()
+                seq = transfer.seq
+            port.write(bytes([seq]) + ABORT_MARK.to_bytes(2, 'big') + (bytes(4) if crc else b''))
+        elif cmd == FILE:
+            request = port.read_exact(4, 1.0)
+            if len(request) == 4:
+                index = int(request, 16) % len(args.files)
+        elif cmd == HEADERS:
+            request = port.read_exact(6, 1.0)
+            if len(request) == 6:
+                first, count = int(request[:4], 16), int(request[4:], 16)
+                heads = b''
+                for k in range(count):
+                    data, _ = files.load((first + k) % len(files))
+                    heads += data[:HEADERS_SIZE].ljust(HEADERS_SIZE, b'\0')
+                if transfer is not None and transfer.path is not None:
+                    finished.append(transfer)
+                transfer = Transfer(port, burst, window, crc, None, heads)
+                transfer.pump()
+
+    if transfer is not None and transfer.done and transfer.path is not None:
+        finished.append(transfer)
+    for t in finished:
+        t.report()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,457 @@
+/*
+ * Erzeugt einen festen Satz Test-BMPs (RLE8, RLE4, 1/4 Bit und 24 Bit) für bmp_bench.
+ * Inhalt und Größen sind deterministisch → Prüfsummen bleiben vergleichbar.
+ *
+ * Aufruf: gen_corpus <Zielverzeichnis>
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum { CONTENT_FLAT, CONTENT_STRIPES, CONTENT_NOISE, CONTENT_PHOTO, CONTENT_OVERLAY,
+               CONTENT_POSTER, CONTENT_BILEVEL } Content;
+
+typedef struct {
+    const char *name;
+    Content content;
+    int width;
+    int height;
+    int bitCount; // 8 = RLE8, 24 = BI_RGB, 4 = RLE4 oder BI_RGB, 1 = BI_RGB
+    int useDelta; // RLE8: Hintergrund (Index 0) über Delta-Escapes (dx/dy) überspringen
+    int uncompressed; // 4 Bit: BI_RGB statt RLE4
+} CorpusEntry;
+
+//Passend zum Display (480x320), exakte Vielfache (Faktor 2/3/4), krumme Faktoren, Hochskalieren, Hochkant und Panorama
+static const CorpusEntry corpus[] = {
+    { "flat",    CONTENT_FLAT,     480,  320,  8 },
+    { "photo",   CONTENT_PHOTO,    480,  320,  8 },
+    { "stripes", CONTENT_STRIPES,  960,  640,  8 },
+    { "photo",   CONTENT_PHOTO,    960,  640,  8 },
+    { "photo",   CONTENT_PHOTO,   1440,  960,  8 },
+    { "flat",    CONTENT_FLAT,    1920, 1280,  8 },
+    { "noise",   CONTENT_NOISE,   1000,  700,  8 },
+    { "photo",   CONTENT_PHOTO,   2400, 1600,  8 },
+    { "photo",   CONTENT_PHOTO,    120,   80,  8 },
+    { "stripes", CONTENT_STRIPES,  150,  100,  8 },
+    { "photo",   CONTENT_PHOTO,    480,  320, 24 },
+    { "photo",   CONTENT_PHOTO,    720,  480, 24 },
+    { "noise",   CONTENT_NOISE,    640,  480, 24 },
+    //Gleiches Overlay einmal mit, einmal ohne Delta → Prüfsummen müssen gleich sein
+    { "overlay_delta", CONTENT_OVERLAY, 960, 640,  8, 1 },
+    { "overlay_plain", CONTENT_OVERLAY, 960, 640,  8, 0 },
+    //Hochkant, vertikal weit unter 1/6 → ein Teil der Quellzeilen wird nur überlesen
+    { "photo",   CONTENT_PHOTO,    400, 3600,  8 },
+    { "photo",   CONTENT_PHOTO,    400, 3600, 24 },
+    //Breiter als MAX_BMP_WIDTH → Streaming-Modus (Spalten-Akkumulatoren, Faktor 8 und krumm)
+    { "panorama", CONTENT_PHOTO,  3840, 1080,  8 },
+    { "panorama", CONTENT_PHOTO,  4096, 1024,  8 },
+    { "panorama", CONTENT_PHOTO,  4096, 1024, 24 },
+    //16 bzw. 2 Farben: gleicher Inhalt als RLE8, RLE4 und ungepackt → Prüfsummen müssen gleich sein
+    { "poster",  CONTENT_POSTER,   960,  640,  8 },
+    { "poster",  CONTENT_POSTER,   960,  640,  4, 0, 0 },
+    { "poster",  CONTENT_POSTER,   960,  640,  4, 0, 1 },
+    { "poster",  CONTENT_POSTER,   723,  483,  8 },
+    { "poster",  CONTENT_POSTER,   723,  483,  4, 0, 0 },
+    { "poster",  CONTENT_POSTER,   723,  483,  4, 0, 1 },
+    { "poster",  CONTENT_POSTER,   150,  100,  8 },
+    { "poster",  CONTENT_POSTER,   150,  100,  4, 0, 0 },
+    { "poster",  CONTENT_POSTER,  3000,  800,  8 },
+    { "poster",  CONTENT_POSTER,  3000,  800,  4, 0, 0 },
+    { "poster",  CONTENT_POSTER,  3000,  800,  4, 0, 1 },
+    { "bilevel", CONTENT_BILEVEL,  960,  640,  8 },
+    { "bilevel", CONTENT_BILEVEL,  960,  640,  1 },
+    { "bilevel", CONTENT_BILEVEL, 1001,  667,  8 },
+    { "bilevel", CONTENT_BILEVEL, 1001,  667,  1 },
+};
+
+static uint32_t rngState = 0x12345678u;
+
+static uint32_t rng(void)
+{
+    //xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+//Farbwert (0..255 bzw. Palette-Index) für Pixel x,y
+static uint8_t sample(Content c, int x, int y, int w, int h, int channel)
+{
+    switch (c)
+    {
+    case CONTENT_FLAT:
+        //Große einfarbige Rechtecke
+        return (uint8_t)(((x * 6 / w) * 40 + (y * 4 / h) * 9 + channel * 31) & 0xFF);
+    case CONTENT_STRIPES:
+        //Senkrechte Streifen, Breite 1..16 Pixel
+        return (uint8_t)((((x / (1 + (y * 16 / h))) * 37) + channel * 11) & 0xFF);
+    case CONTENT_NOISE:
+        return (uint8_t)rng();
+    case CONTENT_OVERLAY:
+    {
+        //Dünn besetzt: einzelne Rahmen/Marker auf Hintergrund 0, viele leere Zeilen
+        int bandY = (y / 40) % 4;
+        if (bandY != 1)
+            return 0;
+        int cell = x % 120;
+        if (cell < 6 || (cell > 50 && cell < 58 && (y % 40) > 30))
+            return (uint8_t)(1 + ((x / 120 + y / 40) % 200));
+        return 0;
+    }
+    case CONTENT_POSTER:
+    {
+        //Verlauf in 16 Stufen, obere Hälfte gerastert (wechselnde Nachbarn → RLE4-Läufe mit zwei Farben)
+        int v = (x * 15 / w + y * 15 / h) / 2;
+        if (y >= h / 2 && ((x + y) & 1))
+            v = (v + 1) & 15;
+        if ((x * 7 + y * 13) % 11 == 0)
+            v = (v + 5) & 15;
+        return (uint8_t)v;
+    }
+    case CONTENT_BILEVEL:
+        //Rahmen wie beim Overlay, dazu ein grobes Schachbrett
+        if (sample(CONTENT_OVERLAY, x, y, w, h, 0) != 0)
+            return 1;
+        return (uint8_t)(((y / 40) % 4 == 3) ? ((x / 5 + y / 5) & 1) : 0);
+    case CONTENT_PHOTO:
+    default:
+    {
+        //Weicher Verlauf, rechts unten zusätzlich etwas Rauschen
+        int v = (x * 255 / w + y * 255 / h + channel * 60) / 2;
+        if (x > w / 2 && y > h / 2)
+            v += (int)(rng() % 8);
+        return (uint8_t)(v & 0xFF);
+    }
+    }
+}
+
+static void put16(FILE *f, uint16_t v)
+{
+    fputc(v & 0xFF, f);
+    fputc(v >> 8, f);
+}
+
+static void put32(FILE *f, uint32_t v)
+{
+    put16(f, (uint16_t)(v & 0xFFFF));
+    put16(f, (uint16_t)(v >> 16));
+}
+
+//RLE8: Läufe ab 3 Pixeln kodiert, sonst Absolute Mode (ab 3 Bytes, auf 16 Bit aufgefüllt)
+static size_t encode_rle8_row(const uint8_t *row, int w, uint8_t *out)
+{
+    size_t n = 0;
+    int x = 0;
+
+    while (x < w)
+    {
+        int run = 1;
+        while (x + run < w && run < 255 && row[x + run] == row[x])
+            run++;
+
+        if (run >= 3)
+        {
+            out[n++] = (uint8_t)run;
+            out[n++] = row[x];
+            x += run;
+            continue;
+        }
+
+        //Literal bis zum nächsten Lauf >= 3
+        int lit = 0;
+        while (x + lit < w && lit < 255)
+        {
+            const uint8_t *p = row + x + lit;
+            if (x + lit + 2 < w && p[0] == p[1] && p[1] == p[2])
+                break;
+            lit++;
+        }
+
+        if (lit < 3)
+        {
+            for (int i = 0; i < lit; i++)
+            {
+                out[n++] = 1;
+                out[n++] = row[x + i];
+            }
+        }
+        else
+        {
+            out[n++] = 0;
+            out[n++] = (uint8_t)lit;
+            memcpy(out + n, row + x, (size_t)lit);
+            n += (size_t)lit;
+            if (lit & 1)
+                out[n++] = 0;
+        }
+        x += lit;
+    }
+
+    out[n++] = 0; // End Of Line
+    out[n++] = 0;
+    return n;
+}
+
+//RLE4: Länge eines Laufs, der ab x zwischen row[x] und row[x + 1] wechselt (gleiche Farbe eingeschlossen)
+static int alt_len(const uint8_t *row, int x, int w)
+{
+    uint8_t a = row[x];
+    uint8_t b = (x + 1 < w) ? row[x + 1] : a;
+    int k = 0;
+    while (x + k < w && k < 255 && row[x + k] == ((k & 1) ? b : a))
+        k++;
+    return k;
+}
+
+//RLE4: Läufe (auch mit zwei Farben im Wechsel) ab 4 Pixeln kodiert, sonst Absolute Mode (gepackte Nibbles)
+static size_t encode_rle4_row(const uint8_t *row, int w, uint8_t *out)
+{
+    size_t n = 0;
+    int x = 0;
+
+    while (x < w)
+    {
+        int run = alt_len(row, x, w);
+        if (run >= 4)
+        {
+            out[n++] = (uint8_t)run;
+            out[n++] = (uint8_t)((row[x] << 4) | ((run > 1) ? row[x + 1] : row[x]));
+            x += run;
+            continue;
+        }
+
+        int lit = 0;
+        while (x + lit < w && lit < 255 && alt_len(row, x + lit, w) < 4)
+            lit++;
+
+        if (lit < 3)
+        {
+            out[n++] = (uint8_t)lit;
+            out[n++] = (uint8_t)((row[x] << 4) | ((lit > 1) ? row[x + 1] : 0));
+        }
+        else
+        {
+            out[n++] = 0;
+            out[n++] = (uint8_t)lit;
+            int bytes = (lit + 1) / 2;
+            for (int i = 0; i < bytes; i++)
+            {
+                uint8_t lo = (2 * i + 1 < lit) ? row[x + 2 * i + 1] : 0;
+                out[n++] = (uint8_t)((row[x + 2 * i] << 4) | lo);
+            }
+            if (bytes & 1)
+                out[n++] = 0;
+        }
+        x += lit;
+    }
+
+    out[n++] = 0; // End Of Line
+    out[n++] = 0;
+    return n;
+}
+
+//1/4 Bit unkomprimiert: Indizes packen (linkes Pixel in den höchstwertigen Bits), auf 4 Byte aufgefüllt
+static size_t pack_row(const uint8_t *row, int w, int bitCount, uint8_t *out)
+{
+    size_t rowBytes = (((size_t)w * (size_t)bitCount + 31) / 32) * 4;
+    memset(out, 0, rowBytes);
+    for (int x = 0; x < w; x++)
+    {
+        int bit = x * bitCount;
+        out[bit / 8] |= (uint8_t)(row[x] << (8 - bitCount - bit % 8));
+    }
+    return rowBytes;
+}
+
+static void put_delta(uint8_t *out, size_t *n, int dx, int dy)
+{
+    out[(*n)++] = 0;
+    out[(*n)++] = 2;
+    out[(*n)++] = (uint8_t)dx;
+    out[(*n)++] = (uint8_t)dy;
+}
+
+//Wie encode_rle8_row, aber Hintergrundläufe (Index 0) ab 4 Pixeln werden Delta (dx, dy = 0)
+//*skipRows: davor liegende leere Zeilen → Delta mit dy an den ersten Pixel dieser Zeile
+static size_t encode_rle8_row_delta(const uint8_t *row, int w, int *skipRows, uint8_t *out)
+{
+    size_t n = 0;
+    int first = 0;
+    while (first < w && row[first] == 0)
+        first++;
+
+    if (first == w)
+    {
+        (*skipRows)++;
+        return 0;
+    }
+
+    int x = 0;
+    while (*skipRows > 0)
+    {
+        int dy = (*skipRows > 255) ? 255 : *skipRows;
+        int dx = (dy == *skipRows) ? ((first > 255) ? 255 : first) : 0;
+        put_delta(out, &n, dx, dy);
+        *skipRows -= dy;
+        x += dx;
+    }
+
+    while (x < w)
+    {
+        int end = x;
+        while (end < w && row[end] == 0)
+            end++;
+        if (end == w)
+            break; // Rest ist Hintergrund → EOL reicht
+        while (end - x >= 4)
+        {
+            int dx = (end - x > 255) ? 255 : end - x;
+            put_delta(out, &n, dx, 0);
+            x += dx;
+        }
+
+        int next = end;
+        while (next < w && !(row[next] == 0 && next + 3 < w && row[next + 1] == 0 && row[next + 2] == 0 && row[next + 3] == 0))
+            next++;
+        size_t len = encode_rle8_row(row + x, next - x, out + n);
+        n += len - 2; // ohne dessen EOL
+        x = next;
+    }
+
+    out[n++] = 0; // End Of Line
+    out[n++] = 0;
+    return n;
+}
+
+static int write_bmp(const char *path, const CorpusEntry *e)
+{
+    int w = e->width;
+    int h = e->height;
+    int rowBytes24 = (w * 3 + 3) & ~3;
+
+    //Pixeldaten erst komplett erzeugen → Dateigröße für den Header bekannt
+    int paletted = (e->bitCount <= 8);
+    int rle = (e->bitCount == 8) || (e->bitCount == 4 && !e->uncompressed);
+    size_t cap = paletted ? (size_t)h * ((size_t)w * 2 + 520) + 2 : (size_t)h * (size_t)rowBytes24;
+    uint8_t *data = malloc(cap);
+    uint8_t *row = malloc((size_t)w * 3 + 4);
+    if (data == NULL || row == NULL)
+    {
+        free(data);
+        free(row);
+        return -1;
+    }
+
+    size_t len = 0;
+    int skipRows = 0;
+    for (int y = 0; y < h; y++)
+    {
+        if (paletted)
+        {
+            for (int x = 0; x < w; x++)
+                row[x] = sample(e->content, x, y, w, h, 0);
+            if (e->bitCount == 4 && !e->uncompressed)
+                len += encode_rle4_row(row, w, data + len);
+            else if (e->bitCount < 8)
+                len += pack_row(row, w, e->bitCount, data + len);
+            else if (e->useDelta)
+                len += encode_rle8_row_delta(row, w, &skipRows, data + len);
+            else
+                len += encode_rle8_row(row, w, data + len);
+        }
+        else
+        {
+            memset(row, 0, (size_t)rowBytes24);
+            for (int x = 0; x < w; x++)
+            {
+                row[3 * x]     = sample(e->content, x, y, w, h, 2); // B
+                row[3 * x + 1] = sample(e->content, x, y, w, h, 1); // G
+                row[3 * x + 2] = sample(e->content, x, y, w, h, 0); // R
+            }
+            memcpy(data + len, row, (size_t)rowBytes24);
+            len += (size_t)rowBytes24;
+        }
+    }
+    if (rle)
+    {
+        data[len++] = 0; // End Of Bitmap
+        data[len++] = 1;
+    }
+
+    int colors = paletted ? (1 << e->bitCount) : 0;
+    uint32_t offBits = 14 + 40 + (uint32_t)colors * 4;
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        free(data);
+        free(row);
+        return -1;
+    }
+
+    //BITMAPFILEHEADER
+    put16(f, 0x4D42);
+    put32(f, offBits + (uint32_t)len);
+    put16(f, 0);
+    put16(f, 0);
+    put32(f, offBits);
+
+    //BITMAPINFOHEADER
+    put32(f, 40);
+    put32(f, (uint32_t)w);
+    put32(f, (uint32_t)h);
+    put16(f, 1);
+    put16(f, (uint16_t)e->bitCount);
+    put32(f, (e->bitCount == 8) ? 1u : (rle ? 2u : 0u)); // BI_RLE8 / BI_RLE4 / BI_RGB
+    put32(f, (uint32_t)len);
+    put32(f, 2835);
+    put32(f, 2835);
+    put32(f, (uint32_t)colors);
+    put32(f, 0);
+
+    //Palette: Farbwürfel-ähnlicher Verlauf
+    for (int i = 0; i < colors; i++)
+    {
+        fputc((i * 7) & 0xFF, f);        // B
+        fputc((i * 3 + 40) & 0xFF, f);   // G
+        fputc(i, f);                     // R
+        fputc(0, f);
+    }
+
+    fwrite(data, 1, len, f);
+    int res = (fclose(f) == 0) ? 0 : -1;
+
+    free(data);
+    free(row);
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Aufruf: %s <Zielverzeichnis>\n", argv[0]);
+        return 2;
+    }
+
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+    {
+        const CorpusEntry *e = &corpus[i];
+        char path[512];
+        const char *format = (e->bitCount == 8) ? "rle8"
+                           : (e->bitCount == 24) ? "rgb24"
+                           : (e->bitCount == 1) ? "rgb1"
+                           : e->uncompressed ? "rgb4" : "rle4";
+        snprintf(path, sizeof(path), "%s/%s_%s_%dx%d.bmp", argv[1], format, e->name, e->width, e->height);
+
+        if (write_bmp(path, e) != 0)
+        {
+            fprintf(stderr, "Fehler beim Schreiben von %s\n", path);
+            return 1;
+        }
+        printf("%s\n", path);
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "input.h"
+#include "host_io.h"
+#include "errorhandler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Host-Ersatz für input.c: Die Datei liegt komplett im Speicher,
+ * nextSpan() liefert höchstens chunk Bytes am Stück, damit die
+ * Span-Grenzen wie auf dem Board mitten in Zeilen und Läufen liegen.
+ */
+
+static char *fileData = NULL;
+static size_t fileSize = 0;
+static size_t readPos = 0;
+static size_t rangeEnd = 0; //Ende der Datei oder des Bereichs nach seekFile
+static int chunkSize = 512;
+
+int host_input_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (NULL == f) {
+        return NOK;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len < 0) {
+        fclose(f);
+        return NOK;
+    }
+
+    char *data = malloc((size_t)len + 1);
+    if (NULL == data || (size_t)len != fread(data, 1, (size_t)len, f)) {
+        free(data);
+        fclose(f);
+        return NOK;
+    }
+    fclose(f);
+
+    free(fileData);
+    fileData = data;
+    fileSize = (size_t)len;
+    readPos = 0;
+    rangeEnd = fileSize;
+    return EOK;
+}
+
+void host_input_set_chunk(int chunk)
+{
+    chunkSize = (chunk > 0) ? chunk : 1;
+}
+
+size_t host_input_size(void)
+{
+    return fileSize;
+}
+
+void initInput(void)
+{
+    readPos = 0;
+    rangeEnd = fileSize;
+}
+
+void openNextFile(void)
+{
+    readPos = 0;
+    rangeEnd = fileSize;
+}
+
+int seekFile(uint32_t offset, uint32_t length)
+{
+    readPos = (offset < fileSize) ? offset : fileSize;
+    rangeEnd = (length < fileSize - readPos) ? readPos + length : fileSize;
+    return EOK;
+}
+
+//Stichproben gibt es nur vom Sender, hier liest der Aufrufer die ganzen Zeilen per seekFile
+int sampleRows(uint32_t offset, uint32_t stride, int pixelSize, int srcWidth, int width,
+               const uint16_t *rows, int count)
+{
+    (void)offset;
+    (void)stride;
+    (void)pixelSize;
+    (void)srcWidth;
+    (void)width;
+    (void)rows;
+    (void)count;
+    return NOK;
+}
+
+uint32_t getFilePos(void)
+{
+    return (uint32_t)readPos;
+}
+
+void stopFile(void)
+{
+    readPos = rangeEnd;
+}
+
+//Die Datei kommt unverändert aus dem Dateisystem, niemand verkleinert sie vorher
+void setPanelFit(bool fit)
+{
+    (void)fit;
+}
+
+//Nur eine Datei im Speicher → keine Dateiliste
+int getFileCount(void)
+{
+    return 0;
+}
+
+int selectFile(int index)
+{
+    (void)index;
+    return NOK;
+}
+
+int openHeaders(int first, int count)
+{
+    (void)first;
+    (void)count;
+    return NOK;
+}
+
+//Die Datei liegt schon ganz im Speicher → nichts vorzuladen
+void prefetchNextFile(void)
+{
+}
+
+bool prefetchPoll(void)
+{
+    return false;
+}
+
+int nextSpan(const char **data)
+{
+    size_t left = rangeEnd - readPos;
+    if (0 == left) {
+        return 0;
+    }
+    //Span endet an der nächsten Chunk-Grenze (wie ein Burst auf dem Board)
+    size_t toBoundary = (size_t)chunkSize - (readPos % (size_t)chunkSize);
+    *data = fileData + readPos;
+    return (int)((left < toBoundary) ? left : toBoundary);
+}
+
+void consumeSpan(int n)
+{
+    readPos += (size_t)n;
+    if (readPos > rangeEnd) {
+        readPos = rangeEnd;
+    }
+}
+
+int nextChar(void)
+{
+    if (readPos >= rangeEnd) {
+        return EOF;
+    }
+    return (unsigned char)fileData[readPos++];
+}
+
+int COMread(char *buf, unsigned int size, unsigned int count)
+{
+    size_t total = (size_t)size * count;
+    if (total > rangeEnd - readPos) {
+        readPos = rangeEnd;
+        return EOF;
+    }
+    memcpy(buf, fileData + readPos, total);
+    readPos += total;
+    return (int)count;
+}
+
+int COMskip(unsigned int n)
+{
+    if (n > rangeEnd - readPos) {
+        readPos = rangeEnd;
+        return EOF;
+    }
+    readPos += n;
+    return EOK;
+}
+
+void sendText(const char *text)
+{
+    printf("%s\n", text);
+}
+
+void getInputStats(InputStats *stats)
+{
+    stats->bytesReceived = (uint32_t)readPos;
+    stats->maxFill = 0;
+    stats->overruns = 0;
+    stats->burstSize = (uint32_t)chunkSize;
+    stats->window = 0;
+    stats->baudRate = 0;
+    stats->crcMode = false;
+    stats->crcErrors = 0;
+    stats->retransmits = 0;
+    stats->prefetched = 0;
+    stats->seekMode = true;
+    stats->abortMode = true;
+    stats->sampleMode = false;
+    stats->panelMode = false;
+}
+
+bool getHeadHash(uint32_t *hash)
+{
+    size_t limit = (fileSize < HEAD_HASH_BYTES) ? fileSize : HEAD_HASH_BYTES;
+    if (readPos < limit) {
+        return false;
+    }
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < limit; i++) {
+        h ^= (uint8_t)fileData[i];
+        h *= 16777619u;
+    }
+    *hash = h;
+    return true;
+}
+
+// EOF
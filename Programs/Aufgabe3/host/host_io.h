@@ -0,0 +1,63 @@
+#ifndef HOST_IO_H
+#define HOST_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_LCD_WIDTH  480
+#define HOST_LCD_HEIGHT 320
+
+/**
+ * @brief Lädt eine Datei komplett in den Speicher. Danach liefern nextChar/nextSpan/COMread
+ *        (input.h) ihren Inhalt, openNextFile() spult wieder an den Anfang.
+ * @retval EOK oder NOK
+ */
+int host_input_load(const char *path);
+
+/**
+ * @brief Größte Anzahl Bytes, die nextSpan() am Stück liefert (wie ein DMA-Burst auf dem Board).
+ *        Standard ist 512 (BUF_SIZE in input.c).
+ */
+void host_input_set_chunk(int chunk);
+
+// Größe der geladenen Datei in Bytes
+size_t host_input_size(void);
+
+// RGB565-Framebuffer, wird über GUI_WriteLine / GUI_clear / GUI_drawPoint beschrieben
+extern uint16_t host_fb[HOST_LCD_HEIGHT][HOST_LCD_WIDTH];
+
+// FNV-1a über den ganzen Framebuffer → Regressionsvergleich ohne Board
+uint32_t host_fb_checksum(void);
+
+// Oberste seit GUI_clear per GUI_WriteLine beschriebene Zeile (HOST_LCD_HEIGHT = noch keine)
+int host_fb_top_row(void);
+
+// Framebuffer als PPM (RGB888) speichern, EOK oder NOK
+int host_fb_write_ppm(const char *path);
+
+// Letzter über GUI_disStr ausgegebener Text (z.B. Fehlermeldung aus lcdErrorMsg)
+const char *host_last_text(void);
+
+/**
+ * @brief uart_loopback: legt ein Pseudo-Terminal als Ersatz für USART3 an (host_uart.c).
+ *        input.c empfängt darüber wie auf dem Board per (nachgebildetem) DMA-Ringpuffer.
+ * @param slavePath  Pfad der Slave-Seite für den Sender (bmp_sender.py)
+ * @retval EOK oder NOK
+ */
+int host_uart_open(const char **slavePath);
+
+// Leitungsrate Sender → Board in Baud (0 = unbegrenzt) und Latenz Board → Sender in µs
+void host_uart_set_line(int baud, long latencyUs);
+
+/**
+ * @brief uart_loopback: Bitfehler in Empfangsrichtung einstreuen.
+ * @param ber      Bitfehlerrate (0 = fehlerfrei)
+ * @param maxBaud  höchste tragfähige Baudrate, darüber mindestens 1e-2 (0 = unbegrenzt)
+ * @param seed     Startwert des Zufallsgenerators (reproduzierbare Fehlerfolge)
+ */
+void host_uart_set_errors(double ber, int maxBaud, long seed);
+
+// Anzahl bisher eingestreuter Bitfehler
+unsigned long host_uart_injected_errors(void);
+
+#endif
@@ -0,0 +1,133 @@
+#include "host_io.h"
+#include "LCD_GUI.h"
+#include "fontsFLASH.h"
+#include "lcd.h"
+#include "errorhandler.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Host-Ersatz für LCD_GUI / lcd: alle Pixel landen im Framebuffer host_fb,
+ * Text wird nicht gerendert, sondern nur gemerkt bzw. auf stderr ausgegeben.
+ */
+
+uint16_t host_fb[HOST_LCD_HEIGHT][HOST_LCD_WIDTH];
+
+sFONT Font8  = { NULL, 5, 8 };
+sFONT Font12 = { NULL, 7, 12 };
+sFONT Font16 = { NULL, 11, 16 };
+
+static char lastText[128];
+static int fbTop = HOST_LCD_HEIGHT; //oberste seit GUI_clear beschriebene Zeile
+
+void GUI_init(uint16_t brightness)
+{
+    (void)brightness;
+    GUI_clear(BLACK);
+}
+
+void GUI_clear(COLOR color)
+{
+    for (int y = 0; y < HOST_LCD_HEIGHT; y++)
+        for (int x = 0; x < HOST_LCD_WIDTH; x++)
+            host_fb[y][x] = color;
+    fbTop = HOST_LCD_HEIGHT;
+}
+
+void GUI_drawPoint(Coordinate pos, COLOR color, DOT_PIXEL size, DOT_STYLE style)
+{
+    (void)size;
+    (void)style;
+    if (pos.x < HOST_LCD_WIDTH && pos.y < HOST_LCD_HEIGHT)
+        host_fb[pos.y][pos.x] = color;
+}
+
+void GUI_disStr(Coordinate pos, const char *str, sFONT *font, COLOR background, COLOR foreground)
+{
+    (void)pos;
+    (void)font;
+    (void)background;
+    (void)foreground;
+    snprintf(lastText, sizeof(lastText), "%s", str);
+}
+
+void GUI_WriteLine(Coordinate pos, uint16_t width, uint16_t *colors)
+{
+    if (pos.y >= HOST_LCD_HEIGHT || pos.x >= HOST_LCD_WIDTH)
+        return;
+    if (width > HOST_LCD_WIDTH - pos.x)
+        width = (uint16_t)(HOST_LCD_WIDTH - pos.x);
+    memcpy(&host_fb[pos.y][pos.x], colors, (size_t)width * sizeof(colors[0]));
+    if (pos.y < fbTop)
+        fbTop = pos.y;
+}
+
+bool checkVersionFlashFonts(void)
+{
+    return true;
+}
+
+void lcdGotoXY(int x, int y)
+{
+    (void)x;
+    (void)y;
+}
+
+void lcdPrintS(const char *str)
+{
+    fputs(str, stderr);
+}
+
+void lcdPrintlnS(const char *str)
+{
+    fputs(str, stderr);
+    fputc('\n', stderr);
+}
+
+const char *host_last_text(void)
+{
+    return lastText;
+}
+
+int host_fb_top_row(void)
+{
+    return fbTop;
+}
+
+uint32_t host_fb_checksum(void)
+{
+    uint32_t h = 2166136261u;
+    for (int y = 0; y < HOST_LCD_HEIGHT; y++)
+    {
+        for (int x = 0; x < HOST_LCD_WIDTH; x++)
+        {
+            uint16_t c = host_fb[y][x];
+            h = (h ^ (c & 0xFFu)) * 16777619u;
+            h = (h ^ (c >> 8)) * 16777619u;
+        }
+    }
+    return h;
+}
+
+int host_fb_write_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (NULL == f)
+        return NOK;
+
+    fprintf(f, "P6\n%d %d\n255\n", HOST_LCD_WIDTH, HOST_LCD_HEIGHT);
+    for (int y = 0; y < HOST_LCD_HEIGHT; y++)
+    {
+        for (int x = 0; x < HOST_LCD_WIDTH; x++)
+        {
+            uint16_t c = host_fb[y][x];
+            uint8_t rgb[3] = {
+                (uint8_t)(((c >> 11) & 0x1F) << 3),
+                (uint8_t)(((c >> 5) & 0x3F) << 2),
+                (uint8_t)((c & 0x1F) << 3)
+            };
+            fwrite(rgb, 1, sizeof(rgb), f);
+        }
+    }
+    return (0 == fclose(f)) ? EOK : NOK;
+}
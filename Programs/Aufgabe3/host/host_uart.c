@@ -0,0 +1,330 @@
+#define _GNU_SOURCE
+#include "host_io.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_ll_crc.h"
+#include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_usart.h"
+#include "errorhandler.h"
+#include "timer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Host-Ersatz für USART3 + DMA1 Stream1 (stubs/stm32f4xx_ll_*.h).
+ * Die Leitung ist der Master eines Pseudo-Terminals, der Sender öffnet die Slave-Seite.
+ * Ein Empfangs-Thread schreibt ankommende Bytes wie der DMA-Controller zirkulär in den
+ * Speicher aus LL_DMA_SetMemoryAddress, zählt NDTR herunter und ruft bei halbem/vollem
+ * Puffer DMA1_Stream1_IRQHandler.
+ * __disable_irq/__enable_irq sperren diesen Thread.
+ *
+ * Optional (host_uart_set_line): Leitungsrate Baud/10 Byte/s in Empfangsrichtung und
+ * eine Latenz für jedes gesendete Byte (Board → Sender), z.B. die des USB-Seriell-Wandlers.
+ * Die Leitungsrate folgt einer ausgehandelten Baudrate (LL_USART_SetBaudRate).
+ *
+ * Leitungsfehler in Empfangsrichtung (host_uart_set_errors): zufällige Bitfehler mit fester Rate,
+ * oberhalb der höchsten tragfähigen Baudrate mindestens 1e-2. Hat das Board die Baudrate einmal
+ * umgestellt und der Sender (termios der Slave-Seite) eine andere, kommt nur Zeichensalat an.
+ */
+
+DMA_TypeDef host_dma1;
+USART_TypeDef host_usart3;
+CRC_TypeDef host_crc;
+
+extern void DMA1_Stream1_IRQHandler(void);
+
+static pthread_mutex_t irqLock = PTHREAD_MUTEX_INITIALIZER;
+static int ptyFd = -1;
+static bool throttle = false;
+static uint32_t boardBaud = 115200;
+static bool baudChanged = false;
+static long latencyUs = 0;
+
+//Leitungsfehler (nur im Empfangs-Thread)
+static double bitErrorRate = 0.0;
+static uint32_t linkMaxBaud = 0;
+static double errorGap = -1.0;      // Bits bis zum nächsten Fehler, < 0: neu ziehen
+static double errorGapRate = 0.0;   // Fehlerrate, mit der errorGap gezogen wurde
+static volatile unsigned long injectedErrors = 0;
+
+//DMA-Zustand (nur mit irqLock)
+static char *dmaMem = NULL;
+static uint32_t dmaLen = 0;
+static uint32_t dmaPos = 0;
+static uint32_t dmaFlagHT = 0;
+static uint32_t dmaFlagTC = 0;
+
+//Sendeschlange für die Latenz: Byte + Zeitpunkt, ab dem es raus darf
+#define TX_QUEUE_SIZE 4096
+static struct { uint8_t value; double due; } txQueue[TX_QUEUE_SIZE];
+static int txHead = 0;
+static int txTail = 0;
+static pthread_mutex_t txLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t txCond = PTHREAD_COND_INITIALIZER;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void sleep_until(double t)
+{
+    double d = t - now_sec();
+    if (d <= 0.0)
+        return;
+    struct timespec ts;
+    ts.tv_sec = (time_t)d;
+    ts.tv_nsec = (long)((d - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+uint32_t getTimeStamp(void)
+{
+    return (uint32_t)(uint64_t)(now_sec() * 1e6);
+}
+
+//Baudrate der Slave-Seite, wie sie der Sender eingestellt hat
+static uint32_t sender_baud(void)
+{
+    static const struct { speed_t speed; uint32_t baud; } speeds[] = {
+        { B9600, 9600 }, { B19200, 19200 }, { B38400, 38400 }, { B57600, 57600 },
+        { B115200, 115200 }, { B230400, 230400 }, { B460800, 460800 }, { B500000, 500000 },
+        { B576000, 576000 }, { B921600, 921600 }, { B1000000, 1000000 }, { B1152000, 1152000 },
+        { B1500000, 1500000 }, { B2000000, 2000000 }, { B2500000, 2500000 }, { B3000000, 3000000 },
+        { B3500000, 3500000 }, { B4000000, 4000000 }
+    };
+    struct termios tio;
+    if (tcgetattr(ptyFd, &tio) != 0)
+        return 0;
+    speed_t speed = cfgetispeed(&tio);
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        if (speeds[i].speed == speed)
+            return speeds[i].baud;
+    }
+    return 0;
+}
+
+//Leitungsfehler in einen empfangenen Block einstreuen
+static void corrupt(uint8_t *data, int n)
+{
+    if (baudChanged && sender_baud() != boardBaud) {
+        for (int i = 0; i < n; i++)
+            data[i] = (uint8_t)lrand48();
+        return;
+    }
+
+    double rate = bitErrorRate;
+    if (linkMaxBaud > 0 && boardBaud > linkMaxBaud && rate < 1e-2)
+        rate = 1e-2;
+    if (rate <= 0.0)
+        return;
+
+    //Abstände zwischen Bitfehlern sind geometrisch verteilt → nur einmal pro Fehler würfeln
+    if (errorGap < 0.0 || rate != errorGapRate) {
+        errorGap = floor(log(1.0 - drand48()) / log(1.0 - rate));
+        errorGapRate = rate;
+    }
+    double bits = (double)n * 8.0;
+    while (errorGap < bits) {
+        long bit = (long)errorGap;
+        data[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        injectedErrors++;
+        errorGap += 1.0 + floor(log(1.0 - drand48()) / log(1.0 - rate));
+    }
+    errorGap -= bits;
+}
+
+void __disable_irq(void)
+{
+    pthread_mutex_lock(&irqLock);
+}
+
+void __enable_irq(void)
+{
+    pthread_mutex_unlock(&irqLock);
+    sched_yield(); // input.c pollt in engen Schleifen → Empfangs-Thread nicht aushungern
+}
+
+//Block wie der DMA-Controller ablegen, mit irqLock
+static void dma_store(const uint8_t *data, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        dmaMem[dmaPos++] = (char)data[i];
+        if (dmaPos == dmaLen / 2) {
+            dmaFlagHT = 1;
+            DMA1_Stream1_IRQHandler();
+        } else if (dmaPos == dmaLen) {
+            dmaPos = 0;
+            dmaFlagTC = 1;
+            DMA1_Stream1_IRQHandler();
+        }
+    }
+}
+
+static void *rx_thread(void *arg)
+{
+    (void)arg;
+    uint8_t buf[256];
+    double lineFree = 0.0; // Zeitpunkt, ab dem die Leitung wieder frei ist
+
+    while (1)
+    {
+        ssize_t n = read(ptyFd, buf, sizeof(buf));
+        if (n <= 0) {
+            if (n < 0 && EINTR == errno)
+                continue;
+            //Sender hat das Terminal geschlossen (EIO) → Programm beenden
+            fprintf(stderr, "Sender getrennt\n");
+            exit(0);
+        }
+
+        if (throttle) {
+            double t = now_sec();
+            if (lineFree < t) lineFree = t;
+            lineFree += (double)n * 10.0 / (double)boardBaud; // 8N1: 10 Bit pro Byte
+            sleep_until(lineFree);
+        }
+        corrupt(buf, (int)n);
+
+        pthread_mutex_lock(&irqLock);
+        dma_store(buf, (int)n);
+        pthread_mutex_unlock(&irqLock);
+    }
+    return NULL;
+}
+
+static void *tx_thread(void *arg)
+{
+    (void)arg;
+    while (1)
+    {
+        pthread_mutex_lock(&txLock);
+        while (txHead == txTail)
+            pthread_cond_wait(&txCond, &txLock);
+        uint8_t value = txQueue[txTail].value;
+        double due = txQueue[txTail].due;
+        txTail = (txTail + 1) % TX_QUEUE_SIZE;
+        pthread_mutex_unlock(&txLock);
+
+        sleep_until(due);
+        if (write(ptyFd, &value, 1) != 1)
+            return NULL;
+    }
+}
+
+int host_uart_open(const char **slavePath)
+{
+    ptyFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (ptyFd < 0 || grantpt(ptyFd) != 0 || unlockpt(ptyFd) != 0)
+        return NOK;
+
+    //Rohdaten ohne Zeilenpuffer, Echo oder Zeichenumsetzung
+    struct termios tio;
+    if (tcgetattr(ptyFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(ptyFd, TCSANOW, &tio);
+    }
+
+    *slavePath = ptsname(ptyFd);
+    return (*slavePath != NULL) ? EOK : NOK;
+}
+
+void host_uart_set_line(int baud, long latency)
+{
+    throttle = baud > 0;
+    if (baud > 0)
+        boardBaud = (uint32_t)baud;
+    latencyUs = latency;
+}
+
+void host_uart_set_errors(double ber, int maxBaud, long seed)
+{
+    bitErrorRate = ber;
+    linkMaxBaud = (maxBaud > 0) ? (uint32_t)maxBaud : 0;
+    srand48(seed);
+}
+
+unsigned long host_uart_injected_errors(void)
+{
+    return injectedErrors;
+}
+
+void LL_USART_SetBaudRate(USART_TypeDef *u, uint32_t periphClk, uint32_t overSampling, uint32_t baud)
+{
+    (void)u;
+    (void)periphClk;
+    (void)overSampling;
+    boardBaud = baud;
+    baudChanged = true;
+}
+
+uint32_t LL_USART_GetBaudRate(USART_TypeDef *u, uint32_t periphClk, uint32_t overSampling)
+{
+    (void)u;
+    (void)periphClk;
+    (void)overSampling;
+    return boardBaud;
+}
+
+void LL_DMA_SetMemoryAddress(DMA_TypeDef *d, uint32_t stream, uint32_t addr)
+{
+    (void)d;
+    (void)stream;
+    dmaMem = (char *)(uintptr_t)addr;
+}
+
+void LL_DMA_SetDataLength(DMA_TypeDef *d, uint32_t stream, uint32_t len)
+{
+    (void)d;
+    (void)stream;
+    dmaLen = len;
+}
+
+uint32_t LL_DMA_GetDataLength(DMA_TypeDef *d, uint32_t stream)
+{
+    (void)d;
+    (void)stream;
+    return dmaLen - dmaPos; // NDTR zählt rückwärts, nach dem Umlauf wieder dmaLen
+}
+
+void LL_DMA_EnableStream(DMA_TypeDef *d, uint32_t stream)
+{
+    (void)d;
+    (void)stream;
+    pthread_t rx, tx;
+    pthread_create(&rx, NULL, rx_thread, NULL);
+    pthread_create(&tx, NULL, tx_thread, NULL);
+}
+
+uint32_t LL_DMA_IsActiveFlag_HT1(DMA_TypeDef *d) { (void)d; return dmaFlagHT; }
+uint32_t LL_DMA_IsActiveFlag_TC1(DMA_TypeDef *d) { (void)d; return dmaFlagTC; }
+void LL_DMA_ClearFlag_HT1(DMA_TypeDef *d) { (void)d; dmaFlagHT = 0; }
+void LL_DMA_ClearFlag_TC1(DMA_TypeDef *d) { (void)d; dmaFlagTC = 0; }
+
+void LL_USART_TransmitData8(USART_TypeDef *u, uint8_t value)
+{
+    (void)u;
+    pthread_mutex_lock(&txLock);
+    int next = (txHead + 1) % TX_QUEUE_SIZE;
+    while (next == txTail) {
+        //Schlange voll → warten wie auf TXE
+        pthread_mutex_unlock(&txLock);
+        sched_yield();
+        pthread_mutex_lock(&txLock);
+    }
+    txQueue[txHead].value = value;
+    txQueue[txHead].due = now_sec() + (double)latencyUs * 1e-6;
+    txHead = next;
+    pthread_cond_signal(&txCond);
+    pthread_mutex_unlock(&txLock);
+}
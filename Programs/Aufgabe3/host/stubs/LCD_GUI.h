@@ -0,0 +1,52 @@
+#ifndef LCD_GUI_H
+#define LCD_GUI_H
+
+/*
+ * Host-Ersatz für DisplayWaveshare/LCD_GUI.h
+ * Es werden nur die Funktionen nachgebildet, die Aufgabe3 benutzt.
+ * Gezeichnet wird in den Framebuffer aus host_io.h.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint16_t COLOR;
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+} Coordinate;
+
+typedef struct {
+    const uint8_t *table;
+    uint16_t Width;
+    uint16_t Height;
+} sFONT;
+
+typedef enum {
+    DOT_PIXEL_1X1 = 1,
+    DOT_PIXEL_2X2,
+    DOT_PIXEL_3X3
+} DOT_PIXEL;
+
+typedef enum {
+    DOT_FILL_AROUND = 1,
+    DOT_FILL_RIGHTUP
+} DOT_STYLE;
+
+#define WHITE   0xFFFF
+#define BLACK   0x0000
+#define BLUE    0x001F
+#define RED     0xF800
+#define GREEN   0x07E0
+#define YELLOW  0xFFE0
+
+#define DEFAULT_BRIGHTNESS 100
+
+void GUI_init(uint16_t brightness);
+void GUI_clear(COLOR color);
+void GUI_drawPoint(Coordinate pos, COLOR color, DOT_PIXEL size, DOT_STYLE style);
+void GUI_disStr(Coordinate pos, const char *str, sFONT *font, COLOR background, COLOR foreground);
+void GUI_WriteLine(Coordinate pos, uint16_t width, uint16_t *colors);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef FONTSFLASH_H
+#define FONTSFLASH_H
+
+// Host-Ersatz für DisplayWaveshare/fontsFLASH.h (Schrift wird nicht gerendert)
+
+#include <stdbool.h>
+#include "LCD_GUI.h"
+
+extern sFONT Font8;
+extern sFONT Font12;
+extern sFONT Font16;
+
+bool checkVersionFlashFonts(void);
+
+#endif
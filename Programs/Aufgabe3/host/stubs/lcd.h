@@ -0,0 +1,10 @@
+#ifndef LCD_H
+#define LCD_H
+
+// Host-Ersatz für ITS_BRD_LIB/lcd.h → Textausgabe landet auf stderr
+
+void lcdGotoXY(int x, int y);
+void lcdPrintS(const char *str);
+void lcdPrintlnS(const char *str);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef STM32F4XX_H
+#define STM32F4XX_H
+
+/*
+ * Host-Ersatz für CMSIS stm32f4xx.h (nur was input.c für uart_loopback braucht).
+ * __disable_irq/__enable_irq sperren den Empfangs-Thread aus host_uart.c.
+ */
+
+#include <stdint.h>
+
+typedef enum {
+    DMA1_Stream1_IRQn = 12
+} IRQn_Type;
+
+void __disable_irq(void);
+void __enable_irq(void);
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) { (void)irq; (void)priority; }
+static inline void NVIC_EnableIRQ(IRQn_Type irq) { (void)irq; }
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef STM32F4XX_LL_BUS_H
+#define STM32F4XX_LL_BUS_H
+
+// Host-Ersatz für stm32f4xx_ll_bus.h → Takte gibt es auf dem Host nicht
+
+#include "stm32f4xx.h"
+
+#define LL_AHB1_GRP1_PERIPH_CRC  0x00001000u
+#define LL_AHB1_GRP1_PERIPH_DMA1 0x00200000u
+
+static inline void LL_AHB1_GRP1_EnableClock(uint32_t periphs) { (void)periphs; }
+
+#endif
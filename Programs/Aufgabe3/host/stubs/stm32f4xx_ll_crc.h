@@ -0,0 +1,27 @@
+#ifndef STM32F4XX_LL_CRC_H
+#define STM32F4XX_LL_CRC_H
+
+/*
+ * Host-Ersatz für stm32f4xx_ll_crc.h: rechnet wie die CRC-Einheit des STM32F4
+ * (CRC-32, Polynom 0x04C11DB7, Start 0xFFFFFFFF, 32-Bit-Worte MSB zuerst, ohne Spiegelung und Abschluss-XOR).
+ */
+
+#include "stm32f4xx.h"
+
+typedef struct { uint32_t DR; } CRC_TypeDef;
+extern CRC_TypeDef host_crc;
+#define CRC (&host_crc)
+
+static inline void LL_CRC_ResetCRCCalculationUnit(CRC_TypeDef *c) { c->DR = 0xFFFFFFFFu; }
+
+static inline void LL_CRC_FeedData32(CRC_TypeDef *c, uint32_t data)
+{
+    uint32_t crc = c->DR ^ data;
+    for (int i = 0; i < 32; i++)
+        crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+    c->DR = crc;
+}
+
+static inline uint32_t LL_CRC_ReadData32(CRC_TypeDef *c) { return c->DR; }
+
+#endif
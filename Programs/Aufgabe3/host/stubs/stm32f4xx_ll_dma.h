@@ -0,0 +1,49 @@
+#ifndef STM32F4XX_LL_DMA_H
+#define STM32F4XX_LL_DMA_H
+
+/*
+ * Host-Ersatz für stm32f4xx_ll_dma.h (DMA1 Stream1, USART3 RX im Ringbetrieb).
+ * Konfiguration ohne Wirkung, Speicher/Länge/NDTR/Flags bildet host_uart.c nach.
+ */
+
+#include "stm32f4xx.h"
+
+typedef struct { int unused; } DMA_TypeDef;
+extern DMA_TypeDef host_dma1;
+#define DMA1 (&host_dma1)
+
+#define LL_DMA_STREAM_1                   1u
+#define LL_DMA_CHANNEL_4                  0x08000000u
+#define LL_DMA_DIRECTION_PERIPH_TO_MEMORY 0u
+#define LL_DMA_PRIORITY_LOW               0u
+#define LL_DMA_MODE_CIRCULAR              0x100u
+#define LL_DMA_PERIPH_NOINCREMENT         0u
+#define LL_DMA_MEMORY_INCREMENT           0x400u
+#define LL_DMA_PDATAALIGN_BYTE            0u
+#define LL_DMA_MDATAALIGN_BYTE            0u
+
+static inline void LL_DMA_SetChannelSelection(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetDataTransferDirection(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetStreamPriorityLevel(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetMode(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetPeriphIncMode(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetMemoryIncMode(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetPeriphSize(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetMemorySize(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_SetPeriphAddress(DMA_TypeDef *d, uint32_t s, uint32_t v) { (void)d; (void)s; (void)v; }
+static inline void LL_DMA_DisableFifoMode(DMA_TypeDef *d, uint32_t s) { (void)d; (void)s; }
+static inline void LL_DMA_EnableIT_HT(DMA_TypeDef *d, uint32_t s) { (void)d; (void)s; }
+static inline void LL_DMA_EnableIT_TC(DMA_TypeDef *d, uint32_t s) { (void)d; (void)s; }
+
+// Adresse kommt als uint32_t → uart_loopback wird ohne PIE gebaut (statische Daten unter 4 GB)
+void LL_DMA_SetMemoryAddress(DMA_TypeDef *d, uint32_t stream, uint32_t addr);
+void LL_DMA_SetDataLength(DMA_TypeDef *d, uint32_t stream, uint32_t len);
+uint32_t LL_DMA_GetDataLength(DMA_TypeDef *d, uint32_t stream);
+void LL_DMA_EnableStream(DMA_TypeDef *d, uint32_t stream);
+
+uint32_t LL_DMA_IsActiveFlag_HT1(DMA_TypeDef *d);
+uint32_t LL_DMA_IsActiveFlag_TC1(DMA_TypeDef *d);
+void LL_DMA_ClearFlag_HT1(DMA_TypeDef *d);
+void LL_DMA_ClearFlag_TC1(DMA_TypeDef *d);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef STM32F4XX_LL_USART_H
+#define STM32F4XX_LL_USART_H
+
+// Host-Ersatz für stm32f4xx_ll_usart.h (USART3 ↔ Pseudo-Terminal aus host_uart.c)
+
+#include "stm32f4xx.h"
+
+typedef struct { int unused; } USART_TypeDef;
+extern USART_TypeDef host_usart3;
+#define USART3 (&host_usart3)
+
+static inline uint32_t LL_USART_DMA_GetRegAddr(USART_TypeDef *u) { (void)u; return 0u; }
+static inline void LL_USART_EnableDMAReq_RX(USART_TypeDef *u) { (void)u; }
+static inline uint32_t LL_USART_IsActiveFlag_TXE(USART_TypeDef *u) { (void)u; return 1u; }
+static inline uint32_t LL_USART_IsActiveFlag_TC(USART_TypeDef *u) { (void)u; return 1u; }
+
+#define LL_USART_OVERSAMPLING_16 0x00000000u
+#define LL_USART_OVERSAMPLING_8  0x00008000u
+
+static inline uint32_t LL_USART_GetOverSampling(USART_TypeDef *u) { (void)u; return LL_USART_OVERSAMPLING_16; }
+
+// Baudrate des Boards: host_uart.c verfälscht Bytes, solange der Sender eine andere eingestellt hat
+void LL_USART_SetBaudRate(USART_TypeDef *u, uint32_t periphClk, uint32_t overSampling, uint32_t baud);
+uint32_t LL_USART_GetBaudRate(USART_TypeDef *u, uint32_t periphClk, uint32_t overSampling);
+
+void LL_USART_TransmitData8(USART_TypeDef *u, uint8_t value);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+// Host-Ersatz für ITS_BRD_LIB/timer.h (Zeitstempel in µs aus host_uart.c, für die Timeouts in input.c)
+
+#include <stdint.h>
+
+#define TICKS_PER_US 1
+
+uint32_t getTimeStamp(void);
+
+#endif
@@ -0,0 +1,378 @@
+/*
+ * Board-Ersatz für Durchsatzmessungen des Übertragungsprotokolls ohne Hardware.
+ *
+ * Läuft mit dem unveränderten input.c (DMA-Pfad) auf einem Pseudo-Terminal
+ * (host_uart.c). Gibt den Pfad der Slave-Seite aus, dort verbindet sich bmp_sender.py.
+ * Pro Datei: Bytes, KB/s und FNV-1a-Prüfsumme (muss zur Ausgabe des Senders passen).
+ *
+ * Aufruf: uart_loopback [-b Baud] [-l Latenz_us] [-n Dateien] [-e Bitfehlerrate] [-m Baud] [-s Startwert] [-d Verweilzeit_ms]
+ *                     [-z Sprünge] [-c Bild.ppm] [-a Bytes] [-p 0|1] [-r 0|1]
+ *   -b  Leitungsrate in Empfangsrichtung (8N1), 0 = unbegrenzt; folgt einer ausgehandelten Baudrate
+ *   -l  Verzögerung jedes gesendeten Bytes (Board → Sender) in µs
+ *   -n  nach n Dateien beenden (sonst bis der Sender das Terminal schließt)
+ *   -e  zufällige Bitfehler in Empfangsrichtung, z.B. 1e-5 (prüft CRC und Wiederholung)
+ *   -m  höchste Baudrate, die die Leitung trägt; darüber Bitfehlerrate 1e-2 (prüft die Aushandlung)
+ *   -s  Startwert für die Bitfehler
+ *   -d  Diashow: vor jeder weiteren Datei so lange vorladen (prefetchNextFile/prefetchPoll),
+ *       die Zeit ab openNextFile zeigt, wie viel davon schon im Speicher lag
+ *   -z  nach jeder Datei so viele zufällige Bereiche per seekFile neu lesen und mit dem
+ *       ersten Durchlauf vergleichen (Pan/Zoom-Zugriffe)
+ *   -c  die Dateien der ersten Seite des Kontaktabzugs vollständig übertragen, danach die Seite
+ *       zeichnen (contact_sheet.c) und als PPM speichern: Zeit und Bytes im Vergleich, dann beenden.
+ *       Exit-Code 1, wenn der Kontaktabzug nicht schneller ist als die größte Datei allein
+ *   -a  jede Datei nach so vielen Bytes per stopFile abbrechen (abgelehnte Datei), misst die Dauer
+ *   -p  0 = Panel-Abfrage ablehnen (setPanelFit wie bei PAN_ZOOM), der Sender schickt die Originaldateien
+ *   -r  Dateien mit render_image zeichnen statt nur zu empfangen, 1 = mit Grobdurchlauf (coarsePass):
+ *       Zeit bis zur obersten Bildzeile (ganzes Bild zu sehen), Gesamtzeit, Bytes und Prüfsumme des
+ *       Framebuffers (muss mit und ohne Grobdurchlauf gleich sein, mit -p 0 werden Bilder verkleinert)
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_io.h"
+#include "input.h"
+#include "errorhandler.h"
+#include "lcd.h"
+#include "LCD_GUI.h"
+#include "contact_sheet.h"
+#include "render.h"
+#include "lcd_output.h"
+
+static double totalBytes = 0.0;
+static double totalSec = 0.0;
+static char *fileCopy = NULL;   //Inhalt der aktuellen Datei für den Vergleich nach seekFile (-z)
+static size_t copySize = 0;
+static double topSec[HOST_LCD_HEIGHT]; //-r: Zeitpunkt, an dem Zeile y als oberste beschrieben war
+static int topRow = HOST_LCD_HEIGHT;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+//Ersatz für errorhandler.c: Protokollfehler beenden das Programm statt endlos zu warten
+int printError(bool cnd, char *file, int line, char *msg, bool loopForEver)
+{
+    if (cnd) {
+        fprintf(stderr, "Error in file %s line %d: %s\n", file, line, msg);
+        if (loopForEver)
+            exit(1);
+        return NOK;
+    }
+    return EOK;
+}
+
+//Ersatz für errorhandler.c: Meldungen des Dekoders nur ausgeben
+void lcdErrorMsg(const char *msg)
+{
+    fprintf(stderr, "LCD: %s\n", msg);
+}
+
+//Kontaktabzug gegen vollständige Übertragung derselben Dateien
+//-c: EOK, wenn der Kontaktabzug schneller steht als die größte seiner Dateien vollständig übertragen ist.
+//Erst die vollständigen Übertragungen: der Sender verkleinert jede Datei nur einmal (bmp_fit.py, mehrere
+//Sekunden für alle), danach vergleichen beide Durchläufe nur noch die Übertragung.
+static int check_sheet(const char *ppm)
+{
+    int cells = getFileCount();
+    if (cells <= 0) {
+        printf("Kontaktabzug: Sender kann keine Dateien auswählen\n");
+        return NOK;
+    }
+    if (cells > SHEET_CELLS)
+        cells = SHEET_CELLS;
+
+    InputStats st;
+    getInputStats(&st);
+    double maxSec = 0.0;
+    size_t maxBytes = 0;
+    uint32_t before = st.bytesReceived;
+    double t0 = now_sec();
+    selectFile(0);
+    for (int k = 0; k < cells; k++)
+    {
+        double f0 = now_sec();
+        openNextFile();
+        size_t bytes = 0;
+        const char *data;
+        int n;
+        while ((n = nextSpan(&data)) > 0) {
+            bytes += (size_t)n;
+            consumeSpan(n);
+        }
+        double sec = now_sec() - f0;
+        if (sec > maxSec) {
+            maxSec = sec;
+            maxBytes = bytes;
+        }
+    }
+    double fullSec = now_sec() - t0;
+    getInputStats(&st);
+    printf("Vollständig: %d Dateien, %.1f ms, %u Bytes, größte Datei %zu Bytes in %.1f ms\n", cells, fullSec * 1e3,
+           (unsigned)(st.bytesReceived - before), maxBytes, maxSec * 1e3);
+
+    before = st.bytesReceived;
+    t0 = now_sec();
+    if (contact_sheet_show(0) != cells) {
+        printf("Kontaktabzug: Dateiauswahl gescheitert\n");
+        return NOK;
+    }
+    double sheetSec = now_sec() - t0;
+    getInputStats(&st);
+    printf("Kontaktabzug: %.1f ms, %u Bytes empfangen\n", sheetSec * 1e3, (unsigned)(st.bytesReceived - before));
+    if (host_fb_write_ppm(ppm) != EOK)
+        printf("%s kann nicht geschrieben werden\n", ppm);
+
+    if (sheetSec >= maxSec) {
+        printf("FEHLER: Kontaktabzug nicht schneller als die größte Datei\n");
+        return NOK;
+    }
+    printf("OK: Kontaktabzug in %.0f %% der Zeit der größten Datei\n", 100.0 * sheetSec / maxSec);
+    return EOK;
+}
+
+//Nach jeder ausgegebenen LCD-Zeile: wann ist das Bild bis zu welcher Zeile sichtbar
+static void row_done(void)
+{
+    int top = host_fb_top_row();
+    double t = now_sec();
+    while (topRow > top)
+        topSec[--topRow] = t;
+}
+
+//Dateien zeichnen wie main.c, ohne Bild-Cache; files < 0: bis der Sender das Terminal schließt
+static void check_render(int files, bool coarse)
+{
+    RenderConfig cfg = {
+        .upscale    = true,
+        .useCache   = false,
+        .readToEnd  = false,
+        .coarsePass = coarse,
+        .stage      = NULL,
+    };
+    lcd_set_row_done_callback(row_done);
+    for (int f = 0; files < 0 || f < files; f++)
+    {
+        InputStats st;
+        getInputStats(&st);
+        uint32_t before = st.bytesReceived;
+        double t0 = now_sec();
+        openNextFile();
+        GUI_clear(BLACK);
+        topRow = HOST_LCD_HEIGHT;
+
+        RenderResult res;
+        int status = render_image(&cfg, &res);
+        double sec = now_sec() - t0;
+        getInputStats(&st);
+        printf("Datei %d: %dx%d, %.1f ms", f + 1, res.srcW, res.srcH, sec * 1e3);
+        if (status == EOK && topRow <= res.offsetY)
+            printf(", oberste Bildzeile nach %.1f ms", (topSec[res.offsetY] - t0) * 1e3);
+        printf(", %u Bytes, Bild %08x%s\n", (unsigned)(st.bytesReceived - before),
+               (unsigned)host_fb_checksum(), (status == EOK) ? "" : ", FEHLER");
+        fflush(stdout);
+    }
+}
+
+//count zufällige Bereiche der aktuellen Datei neu anfordern, false bei abweichenden Bytes
+static bool check_seeks(size_t size, int count, double *sec, size_t *bytes)
+{
+    double t0 = now_sec();
+    for (int k = 0; k < count; k++)
+    {
+        uint32_t offset = (uint32_t)(rand() % (int)(size + 1));
+        uint32_t length = (k % 4 == 3) ? SEEK_TO_END : (uint32_t)(rand() % 8192);
+        if (seekFile(offset, length) != EOK)
+            return false;
+
+        size_t expected = size - offset;
+        if (length < expected)
+            expected = length;
+        size_t got = 0;
+        const char *data;
+        int n;
+        while ((n = nextSpan(&data)) > 0)
+        {
+            if (got + (size_t)n > expected || 0 != memcmp(data, fileCopy + offset + got, (size_t)n))
+                return false;
+            got += (size_t)n;
+            consumeSpan(n);
+        }
+        if (got != expected || getFilePos() != offset + expected)
+            return false;
+        *bytes += got;
+    }
+    *sec = now_sec() - t0;
+    return true;
+}
+
+static void print_summary(void)
+{
+    InputStats st;
+    getInputStats(&st);
+    printf("Summe: %.0f Bytes, %.1f KB/s, Ringpuffer max. %u Bytes, Überläufe %u\n",
+           totalBytes, (totalSec > 0.0) ? totalBytes / totalSec / 1024.0 : 0.0,
+           (unsigned)st.maxFill, (unsigned)st.overruns);
+    printf("Bitfehler eingestreut %lu, CRC-Fehler %u, Wiederholungen %u\n",
+           host_uart_injected_errors(), (unsigned)st.crcErrors, (unsigned)st.retransmits);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    int baud = 0;
+    long latency = 0;
+    int files = -1;
+    double ber = 0.0;
+    int maxBaud = 0;
+    long seed = 1;
+    long dwellMs = 0;
+    int seeks = 0;
+    const char *sheetPpm = NULL;
+    long abortAfter = 0;
+    int panelFit = 1;
+    int render = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Option %s braucht einen Wert\n", argv[i]);
+            return 2;
+        }
+        if (0 == strcmp(argv[i], "-b")) {
+            baud = atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-l")) {
+            latency = atol(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-n")) {
+            files = atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-e")) {
+            ber = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-m")) {
+            maxBaud = atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-s")) {
+            seed = atol(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-d")) {
+            dwellMs = atol(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-z")) {
+            seeks = atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-c")) {
+            sheetPpm = argv[++i];
+        } else if (0 == strcmp(argv[i], "-a")) {
+            abortAfter = atol(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-p")) {
+            panelFit = atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "-r")) {
+            render = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Aufruf: %s [-b Baud] [-l Latenz_us] [-n Dateien] [-e Bitfehlerrate] [-m Baud] [-s Startwert]"
+                    " [-d Verweilzeit_ms] [-z Sprünge] [-c Bild.ppm] [-a Bytes] [-p 0|1] [-r 0|1]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const char *path;
+    if (host_uart_open(&path) != EOK) {
+        fprintf(stderr, "Pseudo-Terminal kann nicht angelegt werden\n");
+        return 1;
+    }
+    host_uart_set_line(baud, latency);
+    host_uart_set_errors(ber, maxBaud, seed);
+    printf("%s\n", path);
+    fflush(stdout);
+    atexit(print_summary);
+
+    setPanelFit(0 != panelFit);
+    initInput();
+
+    InputStats st;
+    getInputStats(&st);
+    if (0 != st.window)
+        printf("Fenster-Protokoll: Burst %u Bytes, %u Bursts unterwegs\n", (unsigned)st.burstSize, (unsigned)st.window);
+    else
+        printf("Altes Protokoll: Burst %u Bytes\n", (unsigned)st.burstSize);
+    printf("Baudrate %u, %s%s%s%s%s%s\n", (unsigned)st.baudRate, st.crcMode ? "CRC32 pro Burst" : "ohne CRC",
+           st.seekMode ? ", Sprünge" : "", (getFileCount() > 0) ? ", Dateiauswahl" : "",
+           st.abortMode ? ", Abbruch" : "", st.sampleMode ? ", Stichproben" : "",
+           st.panelMode ? ", Panel gemeldet" : "");
+    fflush(stdout);
+
+    if (NULL != sheetPpm)
+        return (check_sheet(sheetPpm) == EOK) ? 0 : 1;
+    if (render >= 0) {
+        check_render(files, render != 0);
+        return 0;
+    }
+
+    for (int f = 0; files < 0 || f < files; f++)
+    {
+        if (dwellMs > 0 && f > 0) {
+            //Bild "steht": nächste Datei in den Vorladepuffer holen
+            prefetchNextFile();
+            double until = now_sec() + (double)dwellMs * 1e-3;
+            while (now_sec() < until)
+                prefetchPoll();
+        }
+
+        double t0 = now_sec();
+        openNextFile();
+        getInputStats(&st);
+        uint32_t prefetched = st.prefetched;
+
+        uint32_t hash = 2166136261u;
+        size_t bytes = 0;
+        double stopSec = -1.0;
+        const char *data;
+        int n;
+        while ((n = nextSpan(&data)) > 0)
+        {
+            if (abortAfter > 0 && bytes >= (size_t)abortAfter) {
+                double s0 = now_sec();
+                stopFile();
+                stopSec = now_sec() - s0;
+                break;
+            }
+            for (int k = 0; k < n; k++) {
+                hash ^= (uint8_t)data[k];
+                hash *= 16777619u;
+            }
+            if (seeks > 0) {
+                if (bytes + (size_t)n > copySize) {
+                    copySize = 2 * (bytes + (size_t)n);
+                    fileCopy = realloc(fileCopy, copySize);
+                }
+                memcpy(fileCopy + bytes, data, (size_t)n);
+            }
+            bytes += (size_t)n;
+            consumeSpan(n);
+        }
+
+        double sec = now_sec() - t0;
+        totalBytes += (double)bytes;
+        totalSec += sec;
+        printf("Datei %d: %zu Bytes, %.1f KB/s, FNV %08x", f + 1, bytes,
+               (sec > 0.0) ? (double)bytes / sec / 1024.0 : 0.0, (unsigned)hash);
+        if (prefetched > 0)
+            printf(", %u Bytes vorgeladen", (unsigned)prefetched);
+        if (stopSec >= 0.0)
+            printf(", abgebrochen in %.1f ms", stopSec * 1e3);
+        if (seeks > 0 && !st.seekMode) {
+            printf(", Sender kann nicht springen");
+        } else if (seeks > 0) {
+            double seekSec = 0.0;
+            size_t seekBytes = 0;
+            if (check_seeks(bytes, seeks, &seekSec, &seekBytes))
+                printf(", %d Sprünge ok (%.1f ms, %zu Bytes je Sprung)", seeks,
+                       seekSec * 1e3 / seeks, seekBytes / (size_t)seeks);
+            else
+                printf(", Sprung FEHLERHAFT");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}